@@ -1,8 +1,28 @@
 #! /bin/sh
 #
-# Scans src/token_enum.h and creates token_names.h
+# Scans src/token_enum.h and creates token_names.h, which has the name and
+# the class bits of each token.
 #
 
+# The token classes, see the TKF_xxx bits in token_enum.h.
+# Each line has a class followed by the tokens that are in it.
+# The tokens between the 'start PP types' and 'end PP types' comments are
+# in the PREPROC class.
+classes="
+COMMENT     COMMENT COMMENT_MULTI COMMENT_CPP
+SL_COMMENT  COMMENT COMMENT_CPP
+NEWLINE     NEWLINE NL_CONT
+SEMICOLON   SEMICOLON VSEMICOLON
+TYPE        TYPE PTR_TYPE BYREF DC_MEMBER QUALIFIER STRUCT ENUM UNION
+BRACE_OPEN  BRACE_OPEN VBRACE_OPEN
+BRACE_CLOSE BRACE_CLOSE VBRACE_CLOSE
+VBRACE      VBRACE_OPEN VBRACE_CLOSE
+PAREN_OPEN  PAREN_OPEN SPAREN_OPEN FPAREN_OPEN
+PAREN_CLOSE PAREN_CLOSE SPAREN_CLOSE FPAREN_CLOSE
+OPENER      PAREN_OPEN SPAREN_OPEN FPAREN_OPEN BRACE_OPEN VBRACE_OPEN SQUARE_OPEN
+CLOSER      PAREN_CLOSE SPAREN_CLOSE FPAREN_CLOSE BRACE_CLOSE VBRACE_CLOSE SQUARE_CLOSE
+"
+
 infile="token_enum.h"
 outfile="token_names.h"
 
@@ -29,5 +49,36 @@ sed -n '/ *CT_/s/CT_\([^,]*\),.*/"\1",/p' $infile >> $outfile
 cat >> $outfile <<EOF
 };
 
+const UINT32 token_flags[] =
+{
+EOF
+
+# Print the class bits for the same lines, with the name as a comment.
+echo "$classes" | awk '
+FNR == NR {
+   for (idx = 2; idx <= NF; idx++)
+   {
+      flags[$idx] = flags[$idx] " | TKF_" $1
+   }
+   next
+}
+/start PP types/ { in_pp = 1 }
+/end PP types/   { in_pp = 0 }
+/ *CT_[^,]*,/ {
+   name = $0
+   sub(/^[^C]*CT_/, "", name)
+   sub(/,.*$/, "", name)
+   val = flags[name]
+   if (in_pp)
+   {
+      val = val " | TKF_PREPROC"
+   }
+   val = (val == "") ? "0" : substr(val, 4)
+   printf("   %-40s /* %s */\n", val ",", name)
+}' - $infile >> $outfile
+
+cat >> $outfile <<EOF
+};
+
 #endif /* TOKEN_NAMES_H_INCLUDED */
 EOF
@@ -3,6 +3,12 @@
 cd tests
 
 ./run_tests.py $@
+res=$?
 
-exit $?
+./run_cli_tests.py || res=1
 
+../scripts/make_keyword_hash.py --check || res=1
+
+../src/lib_test || res=1
+
+exit $res
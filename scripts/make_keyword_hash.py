@@ -0,0 +1,151 @@
+#! /usr/bin/env python
+#
+#  Creates src/keyword_hash.h, the perfect hash of the names in the keywords[]
+#  table in src/keywords.cpp. Run this after changing the table and commit the
+#  result, like scripts/punc.py for src/punctuators.h.
+#  With --check, nothing is written and this fails if keyword_hash.h is not up
+#  to date. run_tests.sh does that, so 'make check' catches a stale file.
+#
+#  The word hash picks a bucket and the seed of that bucket picks the slot.
+#  The seeds are chosen, biggest bucket first, so that no two names share a
+#  slot. The hashes must match kw_hash() and kw_slot() in keywords.cpp.
+#  If no seed is found for a bucket, then this fails.
+#
+# @author  Ben Gardner
+# @license GPL v2+
+#
+
+import os
+import re
+import sys
+
+HASH_SIZE    = 1024   # power of 2, about four times the names
+HASH_BUCKETS = 128
+MAX_SEED     = 100000
+MASK32       = 0xffffffff
+
+def scan_file(filename):
+	"""
+	returns the names in the keywords[] table, with the index of the first
+	entry of each name
+	"""
+	fh = open(filename, 'r')
+	lines = fh.readlines()
+	fh.close()
+
+	names = []
+	in_table = False
+	idx = 0
+	for line in lines:
+		if line.startswith('static const chunk_tag_t keywords[]'):
+			in_table = True
+		elif in_table:
+			if line.startswith('};'):
+				break
+			mo = re.match(r'\s*\{\s*"([^"\\]*)"\s*,\s*CT_\w+', line)
+			if mo:
+				name = mo.group(1)
+				if len(names) == 0 or names[-1][0] != name:
+					names.append([name, idx])
+				idx += 1
+	return names
+
+def kw_hash(word):
+	h = 2166136261
+	for ch in bytearray(word.encode('ascii')):
+		h = ((h ^ ch) * 16777619) & MASK32
+	return h
+
+def kw_slot(h, seed):
+	h ^= seed
+	h ^= h >> 16
+	h = (h * 0x85ebca6b) & MASK32
+	h ^= h >> 13
+	h = (h * 0xc2b2ae35) & MASK32
+	h ^= h >> 16
+	return h & (HASH_SIZE - 1)
+
+def place_bucket(bucket, slots):
+	"""
+	finds a seed that puts all the names of the bucket in empty slots and
+	puts them there
+	"""
+	for seed in range(1, MAX_SEED):
+		idxs = [ kw_slot(kw_hash(name), seed) for name, kw_idx in bucket ]
+		if len(set(idxs)) == len(idxs) and all(slots[sidx] < 0 for sidx in idxs):
+			for sidx, entry in zip(idxs, bucket):
+				slots[sidx] = entry[1]
+			return seed
+	return 0
+
+def emit_table(out, decl, values, per_line, width):
+	out.append(decl)
+	out.append('{')
+	for idx in range(0, len(values), per_line):
+		row = values[idx:idx + per_line]
+		out.append('   ' + ' '.join([ '%*d,' % (width, val) for val in row ]))
+	out.append('};')
+
+def main():
+	top = os.path.dirname(os.path.dirname(os.path.abspath(sys.argv[0])))
+	names = scan_file(os.path.join(top, 'src', 'keywords.cpp'))
+	if len(names) == 0 or len(names) * 2 > HASH_SIZE:
+		sys.stderr.write('%s: bad number of keywords: %d\n' % (sys.argv[0], len(names)))
+		return 1
+
+	buckets = [ [] for idx in range(HASH_BUCKETS) ]
+	for entry in names:
+		buckets[kw_hash(entry[0]) % HASH_BUCKETS].append(entry)
+
+	# biggest bucket first, in bucket order for the same size
+	order = sorted(range(HASH_BUCKETS), key=lambda b_idx: -len(buckets[b_idx]))
+
+	seeds = [ 0 ] * HASH_BUCKETS
+	slots = [ -1 ] * HASH_SIZE
+	for b_idx in order:
+		if len(buckets[b_idx]) == 0:
+			break
+		seeds[b_idx] = place_bucket(buckets[b_idx], slots)
+		if seeds[b_idx] == 0:
+			sys.stderr.write('%s: no seed for the keyword \'%s\'\n' %
+			                 (sys.argv[0], buckets[b_idx][0][0]))
+			return 1
+
+	out = []
+	out.append('/*')
+	out.append(' * Generated by %s from the keywords[] table in keywords.cpp' %
+	           os.path.basename(sys.argv[0]))
+	out.append(' */')
+	out.append('#ifndef KEYWORD_HASH_H_INCLUDED')
+	out.append('#define KEYWORD_HASH_H_INCLUDED')
+	out.append('')
+	out.append('#define KW_HASH_SIZE       %d' % HASH_SIZE)
+	out.append('#define KW_HASH_BUCKETS    %d' % HASH_BUCKETS)
+	out.append('')
+	out.append('/* The seed of each bucket */')
+	emit_table(out, 'static const UINT32 kw_hash_seed[KW_HASH_BUCKETS] =', seeds, 10, 5)
+	out.append('')
+	out.append('/* The index in keywords[] of the first entry of the name in each slot, or -1 */')
+	emit_table(out, 'static const short kw_hash_slot[KW_HASH_SIZE] =', slots, 16, 3)
+	out.append('')
+	out.append('#endif /* KEYWORD_HASH_H_INCLUDED */')
+
+	text     = '\n'.join(out) + '\n'
+	filename = os.path.join(top, 'src', 'keyword_hash.h')
+	if '--check' in sys.argv[1:]:
+		fh = open(filename, 'r')
+		old = fh.read()
+		fh.close()
+		if old != text:
+			sys.stderr.write('%s: %s is out of date, run %s\n' %
+			                 (sys.argv[0], filename, sys.argv[0]))
+			return 1
+		return 0
+
+	fh = open(filename, 'w')
+	fh.write(text)
+	fh.close()
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -1,6 +1,7 @@
 #! /usr/bin/env python
 #
-#  Creates a possibly faster lookup table for tokens, etc.
+#  Creates the punctuator matcher in src/punctuators.h from the tables in
+#  src/punctuators.cpp.
 #
 # @author  Ben Gardner
 # @license GPL v2+
@@ -30,81 +31,83 @@ def scan_file (filename):
 					token_idx += 1
 	return args
 
-def build_table (db, prev, arr):
-	start_idx = len(arr)
-
-	# do the current level first
-	k = db.keys();
-	if len(k) <= 0:
-		return
-
-	k.sort()
-	num_left = len(k)
-	for i in k:
-		did_one = 1
-		en = db[i]
-		# [ char, full-string, left-in-group, next_index, table-entry ]
-		num_left -= 1
-		arr.append([en[0], prev + en[0], num_left, 0, en[2]])
-
-	# update the one-up level index
-	if len(prev) > 0:
-		for idx in range(0, len(arr)):
-			if arr[idx][1] == prev:
-				arr[idx][3] = start_idx
-				break
+def add_to_trie(entry, trie):
+	"""
+	adds an entry to the trie, which maps a char to [ entry, sub-trie ]
+	"""
+	cur = trie
+	tok = entry[0]
+	for idx in range(0, len(tok)):
+		if not tok[idx] in cur:
+			cur[tok[idx]] = [ None, {} ]
+		if idx == len(tok) - 1:
+			cur[tok[idx]][0] = entry
+		else:
+			cur = cur[tok[idx]][1]
 
-	# Now do each sub level
-	for i in k:
-		en = db[i]
-		build_table(en[3], prev + en[0], arr)
+def char_lit(ch):
+	if ch == "'" or ch == '\\':
+		return "'\\%s'" % ch
+	return "'%s'" % ch
 
-def add_to_db(entry, db_top):
+def emit_switch(trie, depth, ind):
 	"""
-	find or create the entry for the first char
+	prints a switch on the char at depth, with a case for each char that
+	starts or continues a punctuator
 	"""
-	str = entry[0]
-	db_cur = db_top
-	for idx in range(0, len(str)):
-		if not str[idx] in db_cur:
-			db_cur[str[idx]] = [ str[idx], 0, None, {} ]
-		dbe = db_cur[str[idx]]
-		if idx == len(str) - 1:
-			dbe[2] = entry
-		else:
-			db_cur = dbe[3]
+	print "%sswitch (str[%d])" % (ind, depth)
+	print "%s{" % ind
+	keys = trie.keys()
+	keys.sort()
+	first = 1
+	for ch in keys:
+		entry, sub = trie[ch]
+		if not first:
+			print ""
+		first = 0
+		print "%scase %s:" % (ind, char_lit(ch))
+		if entry != None:
+			print "%s   if ((%s.lang_flags & lang_flags) != 0)" % (ind, entry[1])
+			print "%s   {" % ind
+			print "%s      p_match = &%s;" % (ind, entry[1])
+			print "%s   }" % ind
+		if len(sub) > 0:
+			print "%s   if (len > %d)" % (ind, depth + 1)
+			print "%s   {" % ind
+			emit_switch(sub, depth + 1, ind + '      ')
+			print "%s   }" % ind
+		print "%s   break;" % ind
+	print "%s}" % ind
 
 if __name__ == '__main__':
 	pl = scan_file('src/punctuators.cpp')
 	pl.sort()
 
-	db = {}
+	trie = {}
 	for a in pl:
-		add_to_db(a, db)
+		add_to_trie(a, trie)
 
-	arr = []
-	build_table(db, '', arr)
-	idx = 0
 	print "/**"
 	print " * @file punctuators.h"
-	print " * Automatically generated"
+	print " * Automatically generated by scripts/punc.py"
+	print " */"
+	print ""
+	print "/**"
+	print " * Finds the longest punctuator at str that is used by the language."
+	print " * There is a nested switch for each char of the punctuators."
+	print " *"
+	print " * @param str   The text, which need not be terminated"
+	print " * @param len   The number of chars that can be read at str"
 	print " */"
-	print "static const lookup_entry_t punc_table[] ="
+	print "static const chunk_tag_t *punc_match(const UINT8 *str, int len, int lang_flags)"
 	print "{"
-	max_len = 0
-	for i in arr:
-		rec = i[4]
-		if rec != None and len(rec[1]) > max_len:
-			max_len = len(rec[1])
-		
-	for i in arr:
-		rec = i[4]
-		if len(i[0]) == 0:
-			print "   {   0,  0,  0, NULL %s },   // %3d:" % ((max_len - 4) * ' ', idx)
-		elif rec == None:
-			print "   { '%s', %2d, %2d, NULL %s },   // %3d: '%s'" % (i[0], i[2], i[3], (max_len - 4) * ' ', idx, i[1])
-		else:
-			print "   { '%s', %2d, %2d, &%s%s },   // %3d: '%s'" % (i[0], i[2], i[3], rec[1], (max_len - len(rec[1])) * ' ', idx, i[1])
-		idx += 1
-	print '};'
-
+	print "   const chunk_tag_t *p_match = NULL;"
+	print ""
+	print "   if (len <= 0)"
+	print "   {"
+	print "      return(NULL);"
+	print "   }"
+	print ""
+	emit_switch(trie, 0, '   ')
+	print "   return(p_match);"
+	print "}"
@@ -63,6 +63,14 @@ public:
    }
 
 
+   /* Forgets all the entries, without touching them */
+   void Clear()
+   {
+      first = NULL;
+      last  = NULL;
+   }
+
+
    void InitEntry(T *obj) const
    {
       if (obj != NULL)
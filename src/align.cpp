@@ -206,21 +206,22 @@ void quick_align_again(void)
    LOG_FMT(LALAGAIN, "%s:\n", __func__);
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
-      if ((pc->align.next != NULL) && (pc->flags & PCF_ALIGN_START))
+      if ((pc->align != NULL) && (pc->align->next != NULL) &&
+          (pc->flags & PCF_ALIGN_START))
       {
          as.Start(100, 0);
-         as.m_right_align = pc->align.right_align;
-         as.m_star_style  = (AlignStack::StarStyle)pc->align.star_style;
-         as.m_amp_style   = (AlignStack::StarStyle)pc->align.amp_style;
-         as.m_gap         = pc->align.gap;
+         as.m_right_align = pc->align->right_align;
+         as.m_star_style  = (AlignStack::StarStyle)pc->align->star_style;
+         as.m_amp_style   = (AlignStack::StarStyle)pc->align->amp_style;
+         as.m_gap         = pc->align->gap;
 
          LOG_FMT(LALAGAIN, "   [%s:%d]", pc->str.c_str(), pc->orig_line);
-         as.Add(pc->align.start);
+         as.Add(pc->align->start);
          pc->flags |= PCF_WAS_ALIGNED;
-         for (tmp = pc->align.next; tmp != NULL; tmp = tmp->align.next)
+         for (tmp = pc->align->next; tmp != NULL; tmp = chunk_align(tmp)->next)
          {
             tmp->flags |= PCF_WAS_ALIGNED;
-            as.Add(tmp->align.start);
+            as.Add(chunk_align(tmp)->start);
             LOG_FMT(LALAGAIN, " => [%s:%d]", tmp->str.c_str(), tmp->orig_line);
          }
          LOG_FMT(LALAGAIN, "\n");
@@ -354,9 +355,7 @@ void align_right_comments(void)
 
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
-      if ((pc->type == CT_COMMENT) ||
-          (pc->type == CT_COMMENT_CPP) ||
-          (pc->type == CT_COMMENT_MULTI))
+      if (chunk_is_comment(pc))
       {
          skip = false;
          if (pc->parent_type == CT_COMMENT_END)
@@ -573,8 +572,7 @@ chunk_t *align_assign(chunk_t *first, int span, int thresh)
       }
 
       /* Recurse if a brace set is found */
-      if ((pc->type == CT_BRACE_OPEN) ||
-          (pc->type == CT_VBRACE_OPEN))
+      if (chunk_is_opening_brace(pc))
       {
          int myspan;
          int mythresh;
@@ -829,7 +827,7 @@ static void align_same_func_call_params()
          if (pc->str.equals(align_root->str))
          {
             fcn_as.Add(pc);
-            align_cur->align.next = pc;
+            chunk_align(align_cur)->next = pc;
             align_cur             = pc;
             align_len++;
             add_str = "  Add";
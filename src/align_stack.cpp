@@ -254,14 +254,15 @@ void AlignStack::Add(chunk_t *start, int seqnum)
       //         ref->str.c_str(), get_token_name(ref->type), ref->column,
       //         col_adj, endcol, m_star_style, m_amp_style, gap);
 
-      ali->align.col_adj = col_adj;
-      ali->align.ref     = ref;
-      ali->align.start   = start;
+      align_ptr_t *al = chunk_align(ali);
+      al->col_adj = col_adj;
+      al->ref     = ref;
+      al->start   = start;
       m_aligned.Push(ali, seqnum);
       m_last_added = 1;
 
       LOG_FMT(LAS, "Add-[%s]: line %d, col %d, adj %d : ref=[%s] endcol=%d\n",
-              ali->str.c_str(), ali->orig_line, ali->column, ali->align.col_adj,
+              ali->str.c_str(), ali->orig_line, ali->column, al->col_adj,
               ref->str.c_str(), endcol);
 
       if (m_min_col > endcol)
@@ -347,13 +348,14 @@ void AlignStack::Flush()
    for (idx = 0; idx < m_aligned.Len(); idx++)
    {
       pc = m_aligned.Get(idx)->m_pc;
+      align_ptr_t *al = chunk_align(pc);
 
       /* Set the column adjust and gap */
       int col_adj = 0;
       int gap     = 0;
-      if (pc != pc->align.ref)
+      if (pc != al->ref)
       {
-         gap = pc->column - (pc->align.ref->column + pc->align.ref->len());
+         gap = pc->column - (al->ref->column + al->ref->len());
       }
       chunk_t *tmp = pc;
       if (chunk_is_str(tmp, "(", 1) && (tmp->parent_type == CT_TYPEDEF))
@@ -363,16 +365,16 @@ void AlignStack::Flush()
       if ((chunk_is_star(tmp) && (m_star_style == SS_DANGLE)) ||
           (chunk_is_addr(tmp) && (m_amp_style == SS_DANGLE)))
       {
-         col_adj = pc->align.start->column - pc->column;
-         gap     = pc->align.start->column - (pc->align.ref->column + pc->align.ref->len());
+         col_adj = al->start->column - pc->column;
+         gap     = al->start->column - (al->ref->column + al->ref->len());
       }
       if (m_right_align)
       {
          /* Adjust the width for signed numbers */
-         int start_len = pc->align.start->len();
-         if (pc->align.start->type == CT_NEG)
+         int start_len = al->start->len();
+         if (al->start->type == CT_NEG)
          {
-            tmp = chunk_get_next(pc->align.start);
+            tmp = chunk_get_next(al->start);
             if ((tmp != NULL) && (tmp->type == CT_NUMBER))
             {
                start_len += tmp->len();
@@ -381,7 +383,7 @@ void AlignStack::Flush()
          col_adj += start_len;
       }
 
-      pc->align.col_adj = col_adj;
+      al->col_adj = col_adj;
 
       /* See if this pushes out the max_col */
       int endcol = pc->column + col_adj;
@@ -404,21 +406,22 @@ void AlignStack::Flush()
    {
       ce = m_aligned.Get(idx);
       pc = ce->m_pc;
+      align_ptr_t *al = chunk_align(pc);
       if (idx == 0)
       {
          pc->flags |= PCF_ALIGN_START;
 
-         pc->align.right_align = m_right_align;
-         pc->align.amp_style   = (int)m_amp_style;
-         pc->align.star_style  = (int)m_star_style;
+         al->right_align = m_right_align;
+         al->amp_style   = (int)m_amp_style;
+         al->star_style  = (int)m_star_style;
       }
-      pc->align.gap  = m_gap;
-      pc->align.next = m_aligned.GetChunk(idx + 1);
+      al->gap  = m_gap;
+      al->next = m_aligned.GetChunk(idx + 1);
 
       /* Indent the token, taking col_adj into account */
-      tmp_col = m_max_col - pc->align.col_adj;
+      tmp_col = m_max_col - al->col_adj;
       LOG_FMT(LAS, "%s: line %d: '%s' to col %d (adj=%d)\n", __func__,
-              pc->orig_line, pc->str.c_str(), tmp_col, pc->align.col_adj);
+              pc->orig_line, pc->str.c_str(), tmp_col, al->col_adj);
       align_to_column(pc, tmp_col);
    }
 
@@ -34,7 +34,7 @@
 /**
  * Check the backup-md5 file and copy the input file to a backup if needed.
  */
-int backup_copy_file(const char *filename, const vector<UINT8>& data)
+int backup_copy_file(const char *filename, const UINT8 *file_data, size_t file_len)
 {
    char  newpath[1024];
    char  buffer[128];
@@ -44,7 +44,7 @@ int backup_copy_file(const char *filename, const vector<UINT8>& data)
 
    md5_str_in[0] = 0;
 
-   MD5::Calc(&data[0], data.size(), dig);
+   MD5::Calc(file_data, file_len, dig);
    snprintf(md5_str, sizeof(md5_str),
             "%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x\n",
             dig[0], dig[1], dig[2], dig[3],
@@ -91,7 +91,7 @@ int backup_copy_file(const char *filename, const vector<UINT8>& data)
    thefile = fopen(newpath, "wb");
    if (thefile != NULL)
    {
-      int retval   = fwrite(&data[0], data.size(), 1, thefile);
+      int retval   = fwrite(file_data, file_len, 1, thefile);
       int my_errno = errno;
 
       fclose(thefile);
@@ -38,7 +38,7 @@
  * @param file_len   The file length
  * @return           SUCCESS or FAILURE
  */
-int backup_copy_file(const char *filename, const vector<UINT8>& data);
+int backup_copy_file(const char *filename, const UINT8 *file_data, size_t file_len);
 
 
 /**
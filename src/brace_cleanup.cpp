@@ -51,12 +51,12 @@ static int preproc_start(struct parse_frame *frm, chunk_t *pc)
          pf_push(frm);
 
          /* a preproc body starts a new, blank frame */
-         memset(frm, 0, sizeof(*frm));
+         frm->reset();
          frm->level       = 1;
          frm->brace_level = 1;
 
          /*TODO: not sure about the next 3 lines */
-         frm->pse_tos = 1;
+         frm->pse_push();
          frm->pse[frm->pse_tos].type  = CT_PP_DEFINE;
          frm->pse[frm->pse_tos].stage = BS_NONE;
       }
@@ -109,8 +109,6 @@ void brace_cleanup(void)
    struct parse_frame frm;
    int                pp_level;
 
-   memset(&frm, 0, sizeof(frm));
-
    cpd.frame_count = 0;
    cpd.in_preproc  = CT_NONE;
    cpd.pp_level    = 0;
@@ -192,8 +190,7 @@ static bool maybe_while_of_do(chunk_t *pc)
 
    if ((prev != NULL) &&
        (prev->parent_type == CT_DO) &&
-       ((prev->type == CT_VBRACE_CLOSE) ||
-        (prev->type == CT_BRACE_CLOSE)))
+       chunk_is_closing_brace(prev))
    {
       return(true);
    }
@@ -204,21 +201,12 @@ static bool maybe_while_of_do(chunk_t *pc)
 static void push_fmr_pse(struct parse_frame *frm, chunk_t *pc,
                          brstage_e stage, const char *logtext)
 {
-   if (frm->pse_tos < ((int)ARRAY_SIZE(frm->pse) - 1))
-   {
-      frm->pse_tos++;
-      frm->pse[frm->pse_tos].type  = pc->type;
-      frm->pse[frm->pse_tos].stage = stage;
-      frm->pse[frm->pse_tos].pc    = pc;
+   frm->pse_push();
+   frm->pse[frm->pse_tos].type  = pc->type;
+   frm->pse[frm->pse_tos].stage = stage;
+   frm->pse[frm->pse_tos].pc    = pc;
 
-      print_stack(LBCSPUSH, logtext, frm, pc);
-   }
-   else
-   {
-      LOG_FMT(LWARN, "%s:%d Error: Frame stack overflow,  Unable to properly process this file.\n",
-              cpd.filename, cpd.line_number);
-      cpd.error_count++;
-   }
+   print_stack(LBCSPUSH, logtext, frm, pc);
 }
 
 
@@ -289,8 +277,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
    /* Mark statement starts */
    if (((frm->stmt_count == 0) || (frm->expr_count == 0)) &&
        !chunk_is_semicolon(pc) &&
-       (pc->type != CT_BRACE_CLOSE) &&
-       (pc->type != CT_VBRACE_CLOSE))
+       !chunk_is_closing_brace(pc))
    {
       pc->flags |= PCF_EXPR_START;
       pc->flags |= (frm->stmt_count == 0) ? PCF_STMT_START : 0;
@@ -358,8 +345,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
 
    /* Handle close paren, vbrace, brace, and square */
    if ((pc->type == CT_PAREN_CLOSE) ||
-       (pc->type == CT_BRACE_CLOSE) ||
-       (pc->type == CT_VBRACE_CLOSE) ||
+       chunk_is_closing_brace(pc) ||
        (pc->type == CT_ANGLE_CLOSE) ||
        (pc->type == CT_MACRO_CLOSE) ||
        (pc->type == CT_SQUARE_CLOSE))
@@ -398,8 +384,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
          /* Copy the parent, update the paren/brace levels */
          pc->parent_type = frm->pse[frm->pse_tos].parent;
          frm->level--;
-         if ((pc->type == CT_BRACE_CLOSE) ||
-             (pc->type == CT_VBRACE_CLOSE) ||
+         if (chunk_is_closing_brace(pc) ||
              (pc->type == CT_MACRO_CLOSE))
          {
             frm->brace_level--;
@@ -437,7 +422,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
          {
             tmp = chunk_get_next_ncnl(pc);
 
-            if ((tmp->type != CT_SEMICOLON) && (tmp->type != CT_VSEMICOLON))
+            if (!chunk_is_semicolon(tmp))
             {
                pawn_add_vsemi_after(pc);
             }
@@ -446,7 +431,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
       else
       {
          /* Complain if this ISN'T a semicolon, but close out WHILE_OF_DO anyway */
-         if ((pc->type == CT_SEMICOLON) || (pc->type == CT_VSEMICOLON))
+         if (chunk_is_semicolon(pc))
          {
             cpd.consumed    = true;
             pc->parent_type = CT_WHILE_OF_DO;
@@ -463,17 +448,13 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
 
    /* Get the parent type for brace and paren open */
    parent = pc->parent_type;
-   if ((pc->type == CT_PAREN_OPEN) ||
-       (pc->type == CT_FPAREN_OPEN) ||
-       (pc->type == CT_SPAREN_OPEN) ||
+   if (chunk_is_paren_open(pc) ||
        (pc->type == CT_BRACE_OPEN))
    {
       prev = chunk_get_prev_ncnl(pc);
       if (prev != NULL)
       {
-         if ((pc->type == CT_PAREN_OPEN) ||
-             (pc->type == CT_FPAREN_OPEN) ||
-             (pc->type == CT_SPAREN_OPEN))
+         if (chunk_is_paren_open(pc))
          {
             /* Set the parent for parens and change paren type */
             if (frm->pse[frm->pse_tos].stage != BS_NONE)
@@ -520,9 +501,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
     * Note that CT_VBRACE_OPEN has already been handled.
     */
    if ((pc->type == CT_BRACE_OPEN) ||
-       (pc->type == CT_PAREN_OPEN) ||
-       (pc->type == CT_FPAREN_OPEN) ||
-       (pc->type == CT_SPAREN_OPEN) ||
+       chunk_is_paren_open(pc) ||
        (pc->type == CT_ANGLE_OPEN) ||
        (pc->type == CT_MACRO_OPEN) ||
        (pc->type == CT_SQUARE_OPEN))
@@ -574,8 +553,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
     */
    if ((pc->type == CT_SQUARE_OPEN) ||
        ((pc->type == CT_BRACE_OPEN) && (pc->parent_type != CT_ASSIGN)) ||
-       (pc->type == CT_BRACE_CLOSE) ||
-       (pc->type == CT_VBRACE_CLOSE) ||
+       chunk_is_closing_brace(pc) ||
        ((pc->type == CT_SPAREN_OPEN) && (pc->parent_type == CT_FOR)) ||
        (chunk_is_semicolon(pc) &&
         (frm->pse[frm->pse_tos].type != CT_PAREN_OPEN) &&
@@ -603,9 +581,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
        (pc->type == CT_RETURN) ||
        (pc->type == CT_GOTO) ||
        (pc->type == CT_CONTINUE) ||
-       (pc->type == CT_PAREN_OPEN) ||
-       (pc->type == CT_FPAREN_OPEN) ||
-       (pc->type == CT_SPAREN_OPEN) ||
+       chunk_is_paren_open(pc) ||
        (pc->type == CT_BRACE_OPEN) ||
        chunk_is_semicolon(pc) ||
        (pc->type == CT_COMMA) ||
@@ -63,8 +63,7 @@ void do_braces(void)
    pc = chunk_get_head();
    while ((pc = chunk_get_next_ncnl(pc)) != NULL)
    {
-      if ((pc->type != CT_BRACE_OPEN) &&
-          (pc->type != CT_VBRACE_OPEN))
+      if (!chunk_is_opening_brace(pc))
       {
          continue;
       }
@@ -297,7 +296,7 @@ static bool can_remove_braces(chunk_t *bopen)
       prev = chunk_get_prev_ncnl(pc, CNAV_PREPROC);
 
       if ((next != NULL) && (next->type == CT_ELSE) &&
-          ((prev->type == CT_BRACE_CLOSE) || (prev->type == CT_VBRACE_CLOSE)) &&
+          chunk_is_closing_brace(prev) &&
           (prev->parent_type == CT_IF))
       {
          LOG_FMT(LBRDEL, " - bailed on '%s'[%s] on line %d due to 'if' and 'else' sequence\n",
@@ -921,6 +920,7 @@ static chunk_t *mod_case_brace_add(chunk_t *cl_colon)
       pc->level++;
       pc->brace_level++;
    }
+   chunk_match_changed();
 
    return(br_open);
 }
@@ -1018,7 +1018,7 @@ static void process_if_chain(chunk_t *br_start)
       pc = chunk_get_next_ncnl(pc, CNAV_PREPROC);
       if ((pc != NULL) && (pc->type == CT_ELSEIF))
       {
-         while ((pc != NULL) && (pc->type != CT_VBRACE_OPEN) && (pc->type != CT_BRACE_OPEN))
+         while ((pc != NULL) && !chunk_is_opening_brace(pc))
          {
             pc = chunk_get_next_ncnl(pc, CNAV_PREPROC);
          }
@@ -1027,7 +1027,7 @@ static void process_if_chain(chunk_t *br_start)
       {
          break;
       }
-      if ((pc->type != CT_BRACE_OPEN) && (pc->type != CT_VBRACE_OPEN))
+      if (!chunk_is_opening_brace(pc))
       {
          break;
       }
@@ -1038,8 +1038,7 @@ static void process_if_chain(chunk_t *br_start)
       LOG_FMT(LBRCH, "%s: add braces on lines[%d]:", __func__, br_cnt);
       while (--br_cnt >= 0)
       {
-         if ((braces[br_cnt]->type == CT_VBRACE_OPEN) ||
-             (braces[br_cnt]->type == CT_VBRACE_CLOSE))
+         if (chunk_is_vbrace(braces[br_cnt]))
          {
             LOG_FMT(LBRCH, " %d", braces[br_cnt]->orig_line);
             convert_vbrace(braces[br_cnt]);
@@ -1080,7 +1079,7 @@ static void mod_full_brace_if_chain(void)
 
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
-      if (((pc->type == CT_BRACE_OPEN) || (pc->type == CT_VBRACE_OPEN)) &&
+      if (chunk_is_opening_brace(pc) &&
           (pc->parent_type == CT_IF))
       {
          process_if_chain(pc);
@@ -0,0 +1,239 @@
+/**
+ * @file cache.cpp
+ * Remembers the result of formatting a file across runs.
+ * See cache.h for the details.
+ *
+ * An entry file starts with a header line, which is either
+ * "uncrustify-cache clean" or "uncrustify-cache LEN", followed by LEN bytes
+ * of output.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "prototypes.h"
+#include "cache.h"
+#include "md5.h"
+#include "logger.h"
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <atomic>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#define UNC_CACHE_MAGIC    "uncrustify-cache"
+
+static bool   cache_enabled;
+static string cache_path;
+static UINT8  cache_cfg_dig[16];
+
+/* Makes the temp file names unique within this process */
+static atomic<unsigned long> cache_tmp_count;
+
+
+static void cache_add_file(MD5& md5, const file_mem& fm)
+{
+   UINT32 len = fm.size();
+
+   md5.Update(&len, sizeof(len));
+   if (len > 0)
+   {
+      md5.Update(fm.bytes(), len);
+   }
+}
+
+
+void cache_init(const char *cache_dir)
+{
+   UINT8         buf[4096];
+   MD5           md5;
+   vector<UINT8> cfg;
+   size_t        len;
+
+   /* Grab the effective config, which includes the version, types and defines */
+   FILE *pf = tmpfile();
+   if (pf == NULL)
+   {
+      LOG_FMT(LERR, "%s: tmpfile() failed: %s (%d) - cache disabled\n",
+              __func__, strerror(errno), errno);
+      return;
+   }
+   save_option_file(pf, false);
+   rewind(pf);
+   while ((len = fread(buf, 1, sizeof(buf), pf)) > 0)
+   {
+      cfg.insert(cfg.end(), buf, buf + len);
+   }
+   fclose(pf);
+
+   md5.Init();
+   if (cfg.size() > 0)
+   {
+      md5.Update(&cfg[0], cfg.size());
+   }
+   cache_add_file(md5, cpd.file_hdr);
+   cache_add_file(md5, cpd.file_ftr);
+   cache_add_file(md5, cpd.func_hdr);
+   cache_add_file(md5, cpd.oc_msg_hdr);
+   cache_add_file(md5, cpd.class_hdr);
+   md5.Final(cache_cfg_dig);
+
+   cache_path = cache_dir;
+   if ((cache_path.size() > 0) &&
+       (cache_path[cache_path.size() - 1] != '/') &&
+       (cache_path[cache_path.size() - 1] != '\\'))
+   {
+      cache_path += PATH_SEP;
+   }
+   cache_enabled = true;
+
+   LOG_FMT(LNOTE, "%s: using %s\n", __func__, cache_path.c_str());
+}
+
+
+/**
+ * Builds the name of the entry file for the input.
+ */
+static string cache_entry_name(const char *filename, const file_mem& fm)
+{
+   MD5        md5;
+   UINT8      dig[16];
+   char       tmp[64];
+   const char *base = path_basename(filename);
+
+   md5.Init();
+   md5.Update(cache_cfg_dig, sizeof(cache_cfg_dig));
+   snprintf(tmp, sizeof(tmp), "%d %d ", cpd.lang_flags, cpd.frag);
+   md5.Update(tmp, strlen(tmp));
+   for (size_t idx = 0; idx < cpd.lines.size(); idx++)
+   {
+      snprintf(tmp, sizeof(tmp), "%d-%d ", cpd.lines[idx].first, cpd.lines[idx].last);
+      md5.Update(tmp, strlen(tmp));
+   }
+   md5.Update(base, strlen(base) + 1);
+   cache_add_file(md5, fm);
+   md5.Final(dig);
+
+   snprintf(tmp, sizeof(tmp),
+            "%02x%c%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x",
+            dig[0], PATH_SEP, dig[1], dig[2], dig[3],
+            dig[4], dig[5], dig[6], dig[7],
+            dig[8], dig[9], dig[10], dig[11],
+            dig[12], dig[13], dig[14], dig[15]);
+   return(cache_path + tmp);
+}
+
+
+cache_result cache_lookup(const char *filename, const file_mem& fm,
+                          vector<UINT8>& out)
+{
+   out.clear();
+   if (!cache_enabled)
+   {
+      return(CACHE_MISS);
+   }
+
+   string entry = cache_entry_name(filename, fm);
+   FILE   *pf   = fopen(entry.c_str(), "rb");
+   if (pf == NULL)
+   {
+      LOG_FMT(LNOTE, "%s: miss for %s\n", __func__, filename);
+      return(CACHE_MISS);
+   }
+
+   cache_result  retval = CACHE_MISS;
+   char          line[64];
+   unsigned long len;
+   long          start;
+   long          end;
+
+   if (fgets(line, sizeof(line), pf) != NULL)
+   {
+      if (strcmp(line, UNC_CACHE_MAGIC " clean\n") == 0)
+      {
+         retval = CACHE_CLEAN;
+      }
+      else if ((sscanf(line, UNC_CACHE_MAGIC " %lu\n", &len) == 1) &&
+               ((start = ftell(pf)) >= 0) &&
+               (fseek(pf, 0, SEEK_END) == 0) &&
+               ((end = ftell(pf)) >= 0) &&
+               ((unsigned long)(end - start) == len) &&
+               (fseek(pf, start, SEEK_SET) == 0))
+      {
+         /* The size was checked, so a truncated entry or a bad LEN is a miss */
+         out.resize(len);
+         if ((len == 0) || (fread(&out[0], len, 1, pf) == 1))
+         {
+            retval = CACHE_CHANGED;
+         }
+      }
+   }
+   fclose(pf);
+
+   if (retval != CACHE_CHANGED)
+   {
+      out.clear();
+   }
+
+   LOG_FMT(LNOTE, "%s: %s for %s\n", __func__,
+           (retval == CACHE_CLEAN) ? "clean" :
+           (retval == CACHE_CHANGED) ? "hit" : "bad entry", filename);
+   return(retval);
+}
+
+
+void cache_store(const char *filename, const file_mem& fm,
+                 const vector<UINT8> *out)
+{
+   if (!cache_enabled)
+   {
+      return;
+   }
+
+   string entry = cache_entry_name(filename, fm);
+   char   suffix[64];
+
+   /* Write to a temp file and rename it, so that a reader never sees a
+    * partial entry, even with several uncrustify processes sharing the cache.
+    */
+   snprintf(suffix, sizeof(suffix), ".%lu.%lu.tmp",
+            (unsigned long)getpid(), ++cache_tmp_count);
+   string tmp = entry + suffix;
+
+   make_folders(tmp);
+
+   FILE *pf = fopen(tmp.c_str(), "wb");
+   if (pf == NULL)
+   {
+      LOG_FMT(LWARN, "%s: unable to create %s: %s (%d)\n",
+              __func__, tmp.c_str(), strerror(errno), errno);
+      return;
+   }
+
+   bool ok;
+   if ((out == NULL) || fm.same_as(*out))
+   {
+      ok = (fputs(UNC_CACHE_MAGIC " clean\n", pf) >= 0);
+   }
+   else
+   {
+      ok = (fprintf(pf, UNC_CACHE_MAGIC " %lu\n", (unsigned long)out->size()) > 0) &&
+           ((out->size() == 0) || (fwrite(&(*out)[0], out->size(), 1, pf) == 1));
+   }
+   if (fclose(pf) != 0)
+   {
+      ok = false;
+   }
+
+#ifdef WIN32
+   /* windows can't rename a file if the target exists */
+   (void)unlink(entry.c_str());
+#endif
+   if (!ok || (rename(tmp.c_str(), entry.c_str()) != 0))
+   {
+      LOG_FMT(LWARN, "%s: unable to store %s in the cache\n", __func__, filename);
+      (void)unlink(tmp.c_str());
+   }
+}
@@ -0,0 +1,75 @@
+/**
+ * @file cache.h
+ * Remembers the result of formatting a file across runs.
+ *
+ * It works like this:
+ *
+ * 1. Call cache_init() once the config, types and defines are loaded
+ *
+ * 2. Read in the file data and call cache_lookup()
+ *
+ * 3. On a miss, do the uncrustify magic and call cache_store()
+ *
+ * An entry is keyed by the MD5 over the input, the language, the '--lines'
+ * ranges, the file name (which may be inserted by a comment header), the
+ * effective config as written by save_option_file() and the comment header
+ * files.
+ * The config includes the version and the user types and defines, so a change
+ * to any of them makes a new set of entries.
+ *
+ * Each entry is a file named after the key in a two level tree under the
+ * cache folder. It holds either a 'clean' marker, meaning that the output is
+ * the same as the input, or the formatted output.
+ * Nothing is ever removed - just delete the folder to clear the cache.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef CACHE_H_INCLUDED
+#define CACHE_H_INCLUDED
+
+#include "uncrustify_types.h"
+
+enum cache_result
+{
+   CACHE_MISS,      /* not in the cache, or the cache is disabled */
+   CACHE_CLEAN,     /* the output is the same as the input */
+   CACHE_CHANGED,   /* the output was loaded from the cache */
+};
+
+
+/**
+ * Enables the cache.
+ * Must be called from the main thread after the config, header, type and
+ * define files are loaded and before any file is processed.
+ *
+ * @param cache_dir  The folder that holds the cache, created if needed
+ */
+void cache_init(const char *cache_dir);
+
+
+/**
+ * Looks up the result of formatting a file.
+ *
+ * @param filename  The file that was read
+ * @param fm        The file data
+ * @param out       Receives the output for CACHE_CHANGED, cleared otherwise
+ * @return          CACHE_MISS, CACHE_CLEAN or CACHE_CHANGED
+ */
+cache_result cache_lookup(const char *filename, const file_mem& fm,
+                          vector<UINT8>& out);
+
+
+/**
+ * Stores the result of formatting a file.
+ * Failures are logged and otherwise ignored.
+ *
+ * @param filename  The file that was read
+ * @param fm        The file data
+ * @param out       The formatted output or NULL if it is the same as the input
+ */
+void cache_store(const char *filename, const file_mem& fm,
+                 const vector<UINT8> *out);
+
+
+#endif /* CACHE_H_INCLUDED */
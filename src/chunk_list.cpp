@@ -14,7 +14,704 @@
 
 typedef ListManager<chunk_t>   ChunkList;
 
-ChunkList g_cl;
+#define CHUNK_SLAB_SIZE    1024
+
+/**
+ * Hands out chunks from slabs that are kept for the life of the thread.
+ * A deleted chunk goes on the free list and chunk_del_all() makes all the
+ * slabs free again in one go, so the chunks and the memory held by their
+ * text are reused by the next file instead of being freed and reallocated.
+ * The align data and the cached links of the chunks come from pools of their
+ * own.
+ */
+template<class T>
+struct slab_pool
+{
+   vector<T *> slabs;
+   size_t      slab_idx;   /* the slab that has the next unused entry */
+   size_t      slot_idx;   /* the next unused entry in that slab */
+   vector<T *> free_list;  /* entries released since release_all() */
+
+   slab_pool() : slab_idx(0), slot_idx(0)
+   {
+   }
+
+   ~slab_pool()
+   {
+      for (size_t idx = 0; idx < slabs.size(); idx++)
+      {
+         delete[] slabs[idx];
+      }
+   }
+
+   T *alloc()
+   {
+      if (!free_list.empty())
+      {
+         T *item = free_list.back();
+         free_list.pop_back();
+         return(item);
+      }
+      if (slot_idx == CHUNK_SLAB_SIZE)
+      {
+         slab_idx++;
+         slot_idx = 0;
+      }
+      if (slab_idx == slabs.size())
+      {
+         slabs.push_back(new T[CHUNK_SLAB_SIZE]);
+      }
+      return(&slabs[slab_idx][slot_idx++]);
+   }
+
+   /* The entries that are handed out */
+   size_t used() const
+   {
+      return(slab_idx * CHUNK_SLAB_SIZE + slot_idx - free_list.size());
+   }
+
+   void release(T *item)
+   {
+      free_list.push_back(item);
+   }
+
+   void release_all()
+   {
+      free_list.clear();
+      slab_idx = 0;
+      slot_idx = 0;
+   }
+};
+
+/* Each formatting thread works on its own chunk list */
+static thread_local ChunkList              g_cl;
+static thread_local slab_pool<chunk_t>     g_pool;
+static thread_local slab_pool<align_ptr_t> g_align_pool;
+static thread_local slab_pool<chunk_links_t> g_links_pool;
+
+/* What the last file used, see chunk_mem_stats() */
+static thread_local chunk_mem_t g_mem_stats;
+
+
+/**
+ * Gets the cached links of a chunk, which start out stale, as no generation
+ * is ever 0.
+ */
+static chunk_links_t *links_of(chunk_t *pc)
+{
+   if (pc->links == NULL)
+   {
+      pc->links = g_links_pool.alloc();
+      memset(pc->links, 0, sizeof(*pc->links));
+   }
+   return(pc->links);
+}
+
+/**
+ * The navigation cache.
+ * chunk_get_next_nc() and friends remember their result in the chunk they
+ * started from and in every chunk they skipped, which all have the same
+ * answer. The cached results are only valid while nav_gen matches g_nav_gen,
+ * which changes when the whole list changes. Adding, deleting or moving a
+ * chunk only fixes up the results next to it, see nav_add() and nav_del().
+ * An unknown result is stored as the chunk itself, as that is never a valid
+ * answer.
+ */
+static thread_local UINT32 g_nav_gen = 1;
+
+
+static void nav_changed(void)
+{
+   g_nav_gen++;
+   if (g_nav_gen == 0)
+   {
+      /* 0 is never current, so that a new chunk starts out stale */
+      g_nav_gen = 1;
+   }
+}
+
+
+static chunk_links_t *nav_refresh(chunk_t *pc)
+{
+   chunk_links_t *lk = links_of(pc);
+
+   if (lk->nav_gen != g_nav_gen)
+   {
+      lk->nav_gen       = g_nav_gen;
+      lk->nav_next_nc   = pc;
+      lk->nav_prev_nc   = pc;
+      lk->nav_next_ncnl = pc;
+      lk->nav_prev_ncnl = pc;
+   }
+   return(lk);
+}
+
+
+static bool nav_skip_c(chunk_t *pc)
+{
+   return(chunk_is_comment(pc));
+}
+
+
+static bool nav_skip_cnl(chunk_t *pc)
+{
+   return((pc != NULL) && token_is(pc->type, TKF_COMMENT | TKF_NEWLINE));
+}
+
+
+/**
+ * Sets the result of a direction for the chunks that come before pc in that
+ * direction and that have it as the result: the one next to pc and the
+ * skipped chunks next to that, up to and including the first one that isn't
+ * skipped.
+ *
+ * @param pc       The chunk next to the first one to change
+ * @param slot     The cached result to set
+ * @param skip     Tells whether a chunk is skipped
+ * @param forward  The direction of the result, the chunks are before pc
+ * @param result   The new result
+ */
+static void nav_set_before(chunk_t *pc, chunk_t *chunk_links_t::*slot,
+                           bool (*skip)(chunk_t *pc), bool forward,
+                           chunk_t *result)
+{
+   chunk_t *tmp = pc;
+
+   while ((tmp = forward ? g_cl.GetPrev(tmp) : g_cl.GetNext(tmp)) != NULL)
+   {
+      nav_refresh(tmp)->*slot = result;
+      if (!skip(tmp))
+      {
+         break;
+      }
+   }
+}
+
+
+/**
+ * Fixes up the results of one kind of navigation after pc was added.
+ * If pc is skipped, then nothing changes. Otherwise pc is the result of the
+ * chunks up to it.
+ */
+static void nav_add_kind(chunk_t *pc, chunk_t *chunk_links_t::*next_slot,
+                         chunk_t *chunk_links_t::*prev_slot, bool (*skip)(chunk_t *pc))
+{
+   if (!skip(pc))
+   {
+      nav_set_before(pc, next_slot, skip, true, pc);
+      nav_set_before(pc, prev_slot, skip, false, pc);
+   }
+}
+
+
+/**
+ * Fixes up the results of one kind of navigation before pc is deleted.
+ * If pc is skipped, then nothing changes. Otherwise the chunks that have pc
+ * as the result get the one after it.
+ */
+static void nav_del_kind(chunk_t *pc, chunk_t *chunk_links_t::*next_slot,
+                         chunk_t *chunk_links_t::*prev_slot, bool (*skip)(chunk_t *pc))
+{
+   if (!skip(pc))
+   {
+      chunk_t *next = pc;
+      chunk_t *prev = pc;
+
+      while (((next = g_cl.GetNext(next)) != NULL) && skip(next))
+      {
+      }
+      while (((prev = g_cl.GetPrev(prev)) != NULL) && skip(prev))
+      {
+      }
+      nav_set_before(pc, next_slot, skip, true, next);
+      nav_set_before(pc, prev_slot, skip, false, prev);
+   }
+}
+
+
+/**
+ * Called after a chunk is added to the list
+ */
+static void nav_add(chunk_t *pc)
+{
+   if (pc->links != NULL)
+   {
+      pc->links->nav_gen = 0;
+   }
+   nav_add_kind(pc, &chunk_links_t::nav_next_nc, &chunk_links_t::nav_prev_nc, nav_skip_c);
+   nav_add_kind(pc, &chunk_links_t::nav_next_ncnl, &chunk_links_t::nav_prev_ncnl, nav_skip_cnl);
+}
+
+
+/**
+ * Called before a chunk is taken out of the list
+ */
+static void nav_del(chunk_t *pc)
+{
+   nav_del_kind(pc, &chunk_links_t::nav_next_nc, &chunk_links_t::nav_prev_nc, nav_skip_c);
+   nav_del_kind(pc, &chunk_links_t::nav_next_ncnl, &chunk_links_t::nav_prev_ncnl, nav_skip_cnl);
+   if (pc->links != NULL)
+   {
+      pc->links->nav_gen = 0;
+   }
+}
+
+
+/**
+ * Steps from cur until a chunk that isn't skipped, using and filling the
+ * navigation cache.
+ *
+ * @param slot     The cached result to use
+ * @param skip     Tells whether a chunk is skipped
+ * @param forward  The direction
+ */
+static chunk_t *nav_cached(chunk_t *cur, chunk_t *chunk_links_t::*slot,
+                           bool (*skip)(chunk_t *pc), bool forward)
+{
+   if (cur == NULL)
+   {
+      return(NULL);
+   }
+
+   chunk_links_t *lk = nav_refresh(cur);
+   if (lk->*slot != cur)
+   {
+      return(lk->*slot);
+   }
+
+   chunk_t *pc = cur;
+   do
+   {
+      pc = forward ? g_cl.GetNext(pc) : g_cl.GetPrev(pc);
+   } while ((pc != NULL) && skip(pc));
+
+   /* Everything up to the result has the same answer */
+   chunk_t *tmp = cur;
+   do
+   {
+      nav_refresh(tmp)->*slot = pc;
+      tmp = forward ? g_cl.GetNext(tmp) : g_cl.GetPrev(tmp);
+   } while (tmp != pc);
+
+   return(pc);
+}
+
+
+/**
+ * The line cache.
+ * Every chunk remembers the first chunk on its line and the newline at the
+ * end of it, which are filled in for all the chunks that a lookup walks over.
+ * The cached values are only valid while line_gen matches g_line_gen, which
+ * changes when a newline is added or deleted, when a chunk is added or
+ * deleted at the start of a line and when chunks are moved.
+ * Adding and deleting chunks elsewhere on a line keeps the cache.
+ */
+static thread_local UINT32 g_line_gen = 1;
+
+
+static void line_changed(void)
+{
+   g_line_gen++;
+   if (g_line_gen == 0)
+   {
+      g_line_gen = 1;
+   }
+}
+
+
+/**
+ * Called before a chunk is deleted or after it is added.
+ */
+static void line_check(chunk_t *pc)
+{
+   chunk_t *prev = g_cl.GetPrev(pc);
+
+   if (chunk_is_newline(pc) || (prev == NULL) || chunk_is_newline(prev))
+   {
+      line_changed();
+   }
+}
+
+
+static chunk_links_t *line_refresh(chunk_t *pc)
+{
+   chunk_links_t *lk = links_of(pc);
+
+   if (lk->line_gen != g_line_gen)
+   {
+      lk->line_gen   = g_line_gen;
+      lk->line_first = NULL;
+      lk->line_nl    = pc;
+   }
+   return(lk);
+}
+
+
+/**
+ * Finds the first chunk on the line, which may be pc.
+ */
+static chunk_t *line_first(chunk_t *pc)
+{
+   chunk_t       *first = pc;
+   chunk_t       *prev;
+   chunk_links_t *lk = line_refresh(pc);
+
+   if (lk->line_first != NULL)
+   {
+      return(lk->line_first);
+   }
+
+   while (((prev = g_cl.GetPrev(first)) != NULL) && !chunk_is_newline(prev))
+   {
+      lk = line_refresh(prev);
+      if (lk->line_first != NULL)
+      {
+         first = lk->line_first;
+         break;
+      }
+      first = prev;
+   }
+
+   /* Everything from first up to pc has the same answer */
+   for (chunk_t *tmp = pc; tmp != first; tmp = g_cl.GetPrev(tmp))
+   {
+      line_refresh(tmp)->line_first = first;
+   }
+   line_refresh(first)->line_first = first;
+   return(first);
+}
+
+
+/**
+ * Finds the newline at the end of the line, which may be pc.
+ * An unknown newline is stored as the chunk itself, as NULL is an answer.
+ */
+static chunk_t *line_nl(chunk_t *pc)
+{
+   chunk_t       *nl = pc;
+   chunk_links_t *lk = line_refresh(pc);
+
+   if (lk->line_nl != pc)
+   {
+      return(lk->line_nl);
+   }
+
+   while ((nl != NULL) && !chunk_is_newline(nl))
+   {
+      nl = g_cl.GetNext(nl);
+      if (nl != NULL)
+      {
+         lk = line_refresh(nl);
+         if (lk->line_nl != nl)
+         {
+            nl = lk->line_nl;
+            break;
+         }
+      }
+   }
+
+   /* Everything from pc up to the newline has the same answer */
+   for (chunk_t *tmp = pc; (tmp != nl) && (tmp != NULL); tmp = g_cl.GetNext(tmp))
+   {
+      line_refresh(tmp)->line_nl = nl;
+   }
+   return(nl);
+}
+
+
+void chunk_nav_changed(void)
+{
+   nav_changed();
+   line_changed();
+}
+
+
+/**
+ * The bracket and scope links.
+ * An opening paren, brace or square remembers its closing match and a closing
+ * one remembers its opening match, so that chunk_skip_to_match() and
+ * chunk_skip_to_match_rev() don't have to walk over everything in between.
+ * Every chunk also remembers the innermost bracket it is in.
+ * The links are set for the whole list by chunk_match_brackets() and are
+ * looked up again when they are missing or stale. They are only valid while
+ * match_gen or scope_gen matches g_match_gen, which changes when a bracket
+ * is added, deleted or moved or when levels are changed. Adding and deleting
+ * other chunks keeps the links.
+ */
+static thread_local UINT32 g_match_gen = 1;
+
+#define BRACKET_KINDS    6
+
+
+static void match_changed(void)
+{
+   g_match_gen++;
+   if (g_match_gen == 0)
+   {
+      g_match_gen = 1;
+   }
+}
+
+
+/**
+ * @return 0 to BRACKET_KINDS - 1 for an opening bracket, -1 for anything else
+ */
+static int open_bracket_kind(c_token_t type)
+{
+   switch (type)
+   {
+   case CT_PAREN_OPEN:
+      return(0);
+
+   case CT_SPAREN_OPEN:
+      return(1);
+
+   case CT_FPAREN_OPEN:
+      return(2);
+
+   case CT_BRACE_OPEN:
+      return(3);
+
+   case CT_VBRACE_OPEN:
+      return(4);
+
+   case CT_SQUARE_OPEN:
+      return(5);
+
+   default:
+      return(-1);
+   }
+}
+
+
+static int close_bracket_kind(c_token_t type)
+{
+   return(open_bracket_kind((c_token_t)(type - 1)));
+}
+
+
+static bool is_bracket(const chunk_t *pc)
+{
+   return(token_is(pc->type, TKF_OPENER | TKF_CLOSER));
+}
+
+
+static void match_set(chunk_t *pc, chunk_t *match)
+{
+   chunk_links_t *lk = links_of(pc);
+
+   lk->match     = match;
+   lk->match_gen = g_match_gen;
+}
+
+
+/**
+ * Finds the match of a bracket like chunk_get_next_type() or
+ * chunk_get_prev_type() does, using and refreshing the link.
+ */
+static chunk_t *match_find(chunk_t *cur, bool forward)
+{
+   c_token_t     type = (c_token_t)(forward ? cur->type + 1 : cur->type - 1);
+   chunk_links_t *lk  = links_of(cur);
+   chunk_t       *end = lk->match;
+
+   if ((lk->match_gen == g_match_gen) && (end != NULL) &&
+       (end->type == type) && (end->level == cur->level))
+   {
+      return(end);
+   }
+
+   end = forward ? chunk_get_next_type(cur, type, cur->level, CNAV_ALL) :
+         chunk_get_prev_type(cur, type, cur->level, CNAV_ALL);
+   if (end != NULL)
+   {
+      match_set(cur, end);
+   }
+   return(end);
+}
+
+
+/**
+ * Same as match_find(), but for any nav.
+ * Outside of a preproc, the first match is the answer unless it is in one.
+ */
+static chunk_t *match_find_nav(chunk_t *cur, bool forward, chunk_nav_t nav)
+{
+   if (nav == CNAV_ALL)
+   {
+      return(match_find(cur, forward));
+   }
+   if ((cur->flags & PCF_IN_PREPROC) == 0)
+   {
+      chunk_t *end = match_find(cur, forward);
+
+      if ((end == NULL) || ((end->flags & PCF_IN_PREPROC) == 0))
+      {
+         return(end);
+      }
+   }
+   return(forward ?
+          chunk_get_next_type(cur, (c_token_t)(cur->type + 1), cur->level, nav) :
+          chunk_get_prev_type(cur, (c_token_t)(cur->type - 1), cur->level, nav));
+}
+
+
+static void scope_set(chunk_t *pc, chunk_t *scope)
+{
+   chunk_links_t *lk = links_of(pc);
+
+   lk->scope     = scope;
+   lk->scope_gen = g_match_gen;
+}
+
+
+void chunk_match_changed(void)
+{
+   match_changed();
+}
+
+
+void chunk_match_brackets(void)
+{
+   /* The opening brackets that don't have a match yet, by level and kind */
+   vector<vector<chunk_t *> > open;
+   /* The last opening bracket, by level and kind */
+   vector<chunk_t *>          last;
+   /* The opening brackets that may still hold a chunk, lowest level first */
+   vector<chunk_t *>          scopes;
+   chunk_t                    *pc;
+
+   match_changed();
+   for (pc = g_cl.GetHead(); pc != NULL; pc = g_cl.GetNext(pc))
+   {
+      /* The scope is the last opening bracket with a lower level */
+      int s_idx = scopes.size();
+      while ((s_idx > 0) && (scopes[s_idx - 1]->level >= pc->level))
+      {
+         s_idx--;
+      }
+      scope_set(pc, (s_idx > 0) ? scopes[s_idx - 1] : NULL);
+
+      bool is_open = true;
+      int  kind    = open_bracket_kind(pc->type);
+
+      if (kind < 0)
+      {
+         is_open = false;
+         kind    = close_bracket_kind(pc->type);
+      }
+      if ((kind < 0) || (pc->level < 0))
+      {
+         continue;
+      }
+
+      size_t idx = pc->level * BRACKET_KINDS + kind;
+      if (idx >= open.size())
+      {
+         open.resize(idx + 1);
+         last.resize(idx + 1, NULL);
+      }
+
+      if (is_open)
+      {
+         open[idx].push_back(pc);
+         last[idx] = pc;
+
+         /* This one is nearer than any with the same or a higher level */
+         scopes.resize(s_idx);
+         scopes.push_back(pc);
+      }
+      else
+      {
+         /* This is the first closing match for all of them */
+         for (size_t o_idx = 0; o_idx < open[idx].size(); o_idx++)
+         {
+            match_set(open[idx][o_idx], pc);
+         }
+         open[idx].clear();
+
+         if (last[idx] != NULL)
+         {
+            match_set(pc, last[idx]);
+         }
+      }
+   }
+}
+
+
+chunk_t *chunk_skip_to_match(chunk_t *cur, chunk_nav_t nav)
+{
+   if ((cur == NULL) || (open_bracket_kind(cur->type) < 0))
+   {
+      return(cur);
+   }
+   return(match_find_nav(cur, true, nav));
+}
+
+
+chunk_t *chunk_skip_to_match_rev(chunk_t *cur, chunk_nav_t nav)
+{
+   if ((cur == NULL) || (close_bracket_kind(cur->type) < 0))
+   {
+      return(cur);
+   }
+   return(match_find_nav(cur, false, nav));
+}
+
+
+static bool scope_valid(chunk_t *pc)
+{
+   if (pc->links == NULL)
+   {
+      return(false);
+   }
+
+   chunk_t *scope = pc->links->scope;
+
+   return((pc->links->scope_gen == g_match_gen) &&
+          ((scope == NULL) ||
+           ((scope->level < pc->level) && (open_bracket_kind(scope->type) >= 0))));
+}
+
+
+chunk_t *chunk_get_scope(chunk_t *pc)
+{
+   if (pc == NULL)
+   {
+      return(NULL);
+   }
+   if (scope_valid(pc))
+   {
+      return(pc->links->scope);
+   }
+
+   /* Nothing between a chunk and its scope has a lower level, so the search
+    * can jump to the scope of any chunk that doesn't have a lower level.
+    */
+   chunk_t *scope = g_cl.GetPrev(pc);
+   while (scope != NULL)
+   {
+      if (scope->level < pc->level)
+      {
+         if (open_bracket_kind(scope->type) >= 0)
+         {
+            break;
+         }
+         scope = g_cl.GetPrev(scope);
+      }
+      else if (scope_valid(scope))
+      {
+         scope = scope->links->scope;
+      }
+      else
+      {
+         scope = g_cl.GetPrev(scope);
+      }
+   }
+   scope_set(pc, scope);
+   return(scope);
+}
+
 
 chunk_t *chunk_get_head(void)
 {
@@ -91,16 +788,22 @@ chunk_t *chunk_dup(const chunk_t *pc_in)
    chunk_t *pc;
 
    /* Allocate the entry */
-   pc = new chunk_t;
-   if (pc == NULL)
-   {
-      exit(1);
-   }
+   pc = g_pool.alloc();
 
    /* Copy all fields and then init the entry */
    *pc = *pc_in;
    g_cl.InitEntry(pc);
 
+   /* The copy is not linked like the original */
+   pc->links = NULL;
+
+   /* ...and has align data of its own */
+   if (pc_in->align != NULL)
+   {
+      pc->align  = NULL;
+      *chunk_align(pc) = *pc_in->align;
+   }
+
    return(pc);
 }
 
@@ -114,7 +817,13 @@ chunk_t *chunk_add(const chunk_t *pc_in)
 
    if ((pc = chunk_dup(pc_in)) != NULL)
    {
+      if (is_bracket(pc))
+      {
+         match_changed();
+      }
       g_cl.AddTail(pc);
+      nav_add(pc);
+      line_check(pc);
    }
    return(pc);
 }
@@ -130,6 +839,10 @@ chunk_t *chunk_add_after(const chunk_t *pc_in, chunk_t *ref)
 
    if ((pc = chunk_dup(pc_in)) != NULL)
    {
+      if (is_bracket(pc))
+      {
+         match_changed();
+      }
       if (ref != NULL)
       {
          g_cl.AddAfter(pc, ref);
@@ -138,6 +851,8 @@ chunk_t *chunk_add_after(const chunk_t *pc_in, chunk_t *ref)
       {
          g_cl.AddHead(pc);
       }
+      nav_add(pc);
+      line_check(pc);
    }
    return(pc);
 }
@@ -153,6 +868,10 @@ chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref)
 
    if ((pc = chunk_dup(pc_in)) != NULL)
    {
+      if (is_bracket(pc))
+      {
+         match_changed();
+      }
       if (ref != NULL)
       {
          g_cl.AddBefore(pc, ref);
@@ -161,6 +880,8 @@ chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref)
       {
          g_cl.AddTail(pc);
       }
+      nav_add(pc);
+      line_check(pc);
    }
    return(pc);
 }
@@ -168,20 +889,78 @@ chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref)
 
 void chunk_del(chunk_t *pc)
 {
+   if (is_bracket(pc))
+   {
+      match_changed();
+   }
+   nav_del(pc);
+   line_check(pc);
    g_cl.Pop(pc);
-   //if ((pc->flags & PCF_OWN_STR) && (pc->str != NULL))
-   //{
-   //   delete[] (char *)pc->str;
-   //   pc->str = NULL;
-   //}
-   delete pc;
+   if (pc->links != NULL)
+   {
+      g_links_pool.release(pc->links);
+   }
+   if (pc->align != NULL)
+   {
+      g_align_pool.release(pc->align);
+   }
+   g_pool.release(pc);
+}
+
+
+/**
+ * Deletes all the chunks at once, at the end of a file.
+ * Any chunk that is still referenced becomes invalid.
+ */
+void chunk_del_all(void)
+{
+   chunk_mem_t& st = g_mem_stats;
+
+   st.chunks     = g_pool.used();
+   st.links      = g_links_pool.used();
+   st.aligns     = g_align_pool.used();
+   st.text_bytes = 0;
+   for (chunk_t *pc = g_cl.GetHead(); pc != NULL; pc = g_cl.GetNext(pc))
+   {
+      st.text_bytes += pc->str.heap_bytes();
+   }
+   st.log_bytes = unc_text::logtext_bytes();
+
+   nav_changed();
+   match_changed();
+   line_changed();
+   g_cl.Clear();
+   g_pool.release_all();
+   g_align_pool.release_all();
+   g_links_pool.release_all();
+}
+
+
+void chunk_mem_stats(chunk_mem_t& stats)
+{
+   stats = g_mem_stats;
+}
+
+
+align_ptr_t *chunk_align(chunk_t *pc)
+{
+   if (pc->align == NULL)
+   {
+      pc->align = g_align_pool.alloc();
+      memset(pc->align, 0, sizeof(*pc->align));
+   }
+   return(pc->align);
 }
 
 
 void chunk_move_after(chunk_t *pc_in, chunk_t *ref)
 {
+   match_changed();
+   line_changed();
+   nav_del(pc_in);
    g_cl.Pop(pc_in);
    g_cl.AddAfter(pc_in, ref);
+   nav_add(pc_in);
 
    /* HACK: Adjust the original column */
    pc_in->column       = ref->column + space_col_align(ref, pc_in);
@@ -197,6 +976,11 @@ chunk_t *chunk_get_next_nl(chunk_t *cur, chunk_nav_t nav)
 {
    chunk_t *pc = cur;
 
+   if (nav == CNAV_ALL)
+   {
+      pc = g_cl.GetNext(cur);
+      return((pc != NULL) ? line_nl(pc) : NULL);
+   }
    do
    {
       pc = chunk_get_next(pc, nav);
@@ -212,6 +996,10 @@ chunk_t *chunk_get_prev_nl(chunk_t *cur, chunk_nav_t nav)
 {
    chunk_t *pc = cur;
 
+   if (nav == CNAV_ALL)
+   {
+      return((cur != NULL) ? g_cl.GetPrev(line_first(cur)) : NULL);
+   }
    do
    {
       pc = chunk_get_prev(pc, nav);
@@ -255,6 +1043,11 @@ chunk_t *chunk_get_prev_nnl(chunk_t *cur, chunk_nav_t nav)
  */
 chunk_t *chunk_get_next_ncnl(chunk_t *cur, chunk_nav_t nav)
 {
+   if (nav == CNAV_ALL)
+   {
+      return(nav_cached(cur, &chunk_links_t::nav_next_ncnl, nav_skip_cnl, true));
+   }
+
    chunk_t *pc = cur;
 
    do
@@ -359,6 +1152,11 @@ chunk_t *chunk_get_prev_nblank(chunk_t *cur, chunk_nav_t nav)
  */
 chunk_t *chunk_get_next_nc(chunk_t *cur, chunk_nav_t nav)
 {
+   if (nav == CNAV_ALL)
+   {
+      return(nav_cached(cur, &chunk_links_t::nav_next_nc, nav_skip_c, true));
+   }
+
    chunk_t *pc = cur;
 
    do
@@ -374,6 +1172,11 @@ chunk_t *chunk_get_next_nc(chunk_t *cur, chunk_nav_t nav)
  */
 chunk_t *chunk_get_prev_ncnl(chunk_t *cur, chunk_nav_t nav)
 {
+   if (nav == CNAV_ALL)
+   {
+      return(nav_cached(cur, &chunk_links_t::nav_prev_ncnl, nav_skip_cnl, false));
+   }
+
    chunk_t *pc = cur;
 
    do
@@ -389,6 +1192,11 @@ chunk_t *chunk_get_prev_ncnl(chunk_t *cur, chunk_nav_t nav)
  */
 chunk_t *chunk_get_prev_nc(chunk_t *cur, chunk_nav_t nav)
 {
+   if (nav == CNAV_ALL)
+   {
+      return(nav_cached(cur, &chunk_links_t::nav_prev_nc, nav_skip_c, false));
+   }
+
    chunk_t *pc = cur;
 
    do
@@ -434,7 +1242,7 @@ chunk_t *chunk_get_next_str(chunk_t *cur, const char *str, int len, int level,
    {
       pc = chunk_get_next(pc, nav);
       if ((pc == NULL) ||
-          ((pc->len() == len) && (memcmp(str, pc->text(), len) == 0) &&
+          (pc->str.equals(str, len) &&
            ((pc->level == level) || (level < 0))))
       {
          break;
@@ -479,7 +1287,7 @@ chunk_t *chunk_get_prev_str(chunk_t *cur, const char *str, int len, int level,
    {
       pc = chunk_get_prev(pc, nav);
       if ((pc == NULL) ||
-          ((pc->len() == len) && (memcmp(str, pc->text(), len) == 0) &&
+          (pc->str.equals(str, len) &&
            ((pc->level == level) || (level < 0))))
       {
          break;
@@ -515,13 +1323,16 @@ bool chunk_is_newline_between(chunk_t *start, chunk_t *end)
  */
 void chunk_swap(chunk_t *pc1, chunk_t *pc2)
 {
+   nav_changed();
+   match_changed();
+   line_changed();
    g_cl.Swap(pc1, pc2);
 }
 
 
 /**
  * Finds the first chunk on the line that pc is on.
- * This just backs up until a newline or NULL is hit.
+ * This backs up until a newline or NULL is hit, or uses the line cache.
  *
  * given: [ a - b - c - n1 - d - e - n2 ]
  * input: [ a | b | c | n1 ] => a
@@ -529,14 +1340,7 @@ void chunk_swap(chunk_t *pc1, chunk_t *pc2)
  */
 chunk_t *chunk_first_on_line(chunk_t *pc)
 {
-   chunk_t *first = pc;
-
-   while (((pc = chunk_get_prev(pc)) != NULL) && !chunk_is_newline(pc))
-   {
-      first = pc;
-   }
-
-   return(first);
+   return((pc != NULL) ? line_first(pc) : NULL);
 }
 
 
@@ -559,6 +1363,10 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
       return;
    }
 
+   nav_changed();
+   match_changed();
+   line_changed();
+
    /**
     * Example start:
     * ? - start1 - a1 - b1 - nl1 - ? - ref2 - start2 - a2 - b2 - nl2 - ?
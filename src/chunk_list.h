@@ -35,6 +35,51 @@ chunk_t *chunk_add_after(const chunk_t *pc_in, chunk_t *ref);
 chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref);
 
 void chunk_del(chunk_t *pc);
+void chunk_del_all(void);
+
+/**
+ * Gets the align data of a chunk, which is only allocated once the chunk
+ * is aligned. Use pc->align to read it without allocating.
+ */
+align_ptr_t *chunk_align(chunk_t *pc);
+
+/**
+ * What the chunks of a file used, taken by chunk_del_all()
+ */
+struct chunk_mem_t
+{
+   size_t chunks;       /* the chunks in use */
+   size_t links;        /* the chunks with cached links */
+   size_t aligns;       /* the chunks with align data */
+   size_t text_bytes;   /* the heap memory of the chunk text */
+   size_t log_bytes;    /* the logging text, see unc_text::c_str() */
+};
+
+/**
+ * Gets what the last file of this thread used
+ */
+void chunk_mem_stats(chunk_mem_t& stats);
+
+/**
+ * Must be called after a chunk is changed to or from a comment or newline
+ * type, so that the cached navigation results are dropped.
+ * Adding, deleting and moving chunks does this already.
+ */
+void chunk_nav_changed(void);
+
+/**
+ * Links all the parens, braces and squares to their matches and all the
+ * chunks to the bracket they are in.
+ * Called once the levels are known.
+ */
+void chunk_match_brackets(void);
+
+/**
+ * Must be called after the level of chunks is changed, so that the bracket
+ * links are checked again.
+ * Adding, deleting and moving brackets does this already.
+ */
+void chunk_match_changed(void);
 void chunk_move_after(chunk_t *pc_in, chunk_t *ref);
 
 chunk_t *chunk_get_head(void);
@@ -72,57 +117,58 @@ chunk_t *chunk_get_prev_nvb(chunk_t *cur, chunk_nav_t nav = CNAV_ALL);
 
 /**
  * Skips to the closing match for the current paren/brace/square.
+ * The partners are linked, so this usually doesn't walk the chunks between.
  *
  * @param cur  The opening paren/brace/square
  * @return     NULL or the matching paren/brace/square
  */
-static_inline
-chunk_t *chunk_skip_to_match(chunk_t *cur, chunk_nav_t nav = CNAV_ALL)
-{
-   if ((cur != NULL) &&
-       ((cur->type == CT_PAREN_OPEN) ||
-        (cur->type == CT_SPAREN_OPEN) ||
-        (cur->type == CT_FPAREN_OPEN) ||
-        (cur->type == CT_BRACE_OPEN) ||
-        (cur->type == CT_VBRACE_OPEN) ||
-        (cur->type == CT_SQUARE_OPEN)))
-   {
-      return(chunk_get_next_type(cur, (c_token_t)(cur->type + 1), cur->level, nav));
-   }
-   return(cur);
-}
+chunk_t *chunk_skip_to_match(chunk_t *cur, chunk_nav_t nav = CNAV_ALL);
+
+/**
+ * Skips back to the opening match for the current paren/brace/square.
+ *
+ * @param cur  The closing paren/brace/square
+ * @return     NULL or the matching paren/brace/square
+ */
+chunk_t *chunk_skip_to_match_rev(chunk_t *cur, chunk_nav_t nav = CNAV_ALL);
+
+/**
+ * Finds the innermost paren/brace/square that a chunk is in, which is the
+ * closest opening one before it with a lower level.
+ * This is a stored link, so walking out through the enclosing brackets only
+ * costs one step per level.
+ *
+ * @param pc  The chunk
+ * @return    NULL at the top level or the opening paren/brace/square
+ */
+chunk_t *chunk_get_scope(chunk_t *pc);
 
 
 static_inline
 bool chunk_is_comment(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_COMMENT) ||
-                           (pc->type == CT_COMMENT_MULTI) ||
-                           (pc->type == CT_COMMENT_CPP)));
+   return((pc != NULL) && token_is(pc->type, TKF_COMMENT));
 }
 
 
 static_inline
 bool chunk_is_single_line_comment(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_COMMENT) ||
-                           (pc->type == CT_COMMENT_CPP)));
+   return((pc != NULL) && token_is(pc->type, TKF_SL_COMMENT));
 }
 
 
 static_inline
 bool chunk_is_newline(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_NEWLINE) ||
-                           (pc->type == CT_NL_CONT)));
+   return((pc != NULL) && token_is(pc->type, TKF_NEWLINE));
 }
 
 
 static_inline
 bool chunk_is_semicolon(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_SEMICOLON) ||
-                           (pc->type == CT_VSEMICOLON)));
+   return((pc != NULL) && token_is(pc->type, TKF_SEMICOLON));
 }
 
 
@@ -143,14 +189,7 @@ bool chunk_is_preproc(chunk_t *pc)
 static_inline
 bool chunk_is_type(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_TYPE) ||
-                           (pc->type == CT_PTR_TYPE) ||
-                           (pc->type == CT_BYREF) ||
-                           (pc->type == CT_DC_MEMBER) ||
-                           (pc->type == CT_QUALIFIER) ||
-                           (pc->type == CT_STRUCT) ||
-                           (pc->type == CT_ENUM) ||
-                           (pc->type == CT_UNION)));
+   return((pc != NULL) && token_is(pc->type, TKF_TYPE));
 }
 
 
@@ -164,14 +203,14 @@ bool chunk_is_token(chunk_t *pc, c_token_t c_token)
 static_inline
 bool chunk_is_str(chunk_t *pc, const char *str, int len)
 {
-   return((pc != NULL) && (pc->len() == len) && (memcmp(pc->text(), str, len) == 0));
+   return((pc != NULL) && pc->str.equals(str, len));
 }
 
 
 static_inline
 bool chunk_is_str_case(chunk_t *pc, const char *str, int len)
 {
-   return((pc != NULL) && (pc->len() == len) && (strncasecmp(pc->text(), str, len) == 0));
+   return((pc != NULL) && pc->str.equals(str, len, true));
 }
 
 
@@ -203,44 +242,35 @@ bool chunk_is_newline_between(chunk_t *start, chunk_t *end);
 static_inline
 bool chunk_is_closing_brace(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_BRACE_CLOSE) ||
-                           (pc->type == CT_VBRACE_CLOSE)));
+   return((pc != NULL) && token_is(pc->type, TKF_BRACE_CLOSE));
 }
 
 
 static_inline
 bool chunk_is_opening_brace(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_BRACE_OPEN) ||
-                           (pc->type == CT_VBRACE_OPEN)));
+   return((pc != NULL) && token_is(pc->type, TKF_BRACE_OPEN));
 }
 
 
 static_inline
 bool chunk_is_vbrace(chunk_t *pc)
 {
-   return((pc != NULL) && ((pc->type == CT_VBRACE_CLOSE) ||
-                           (pc->type == CT_VBRACE_OPEN)));
+   return((pc != NULL) && token_is(pc->type, TKF_VBRACE));
 }
 
 
 static_inline
 bool chunk_is_paren_open(chunk_t *pc)
 {
-   return((pc != NULL) &&
-          ((pc->type == CT_PAREN_OPEN) ||
-           (pc->type == CT_SPAREN_OPEN) ||
-           (pc->type == CT_FPAREN_OPEN)));
+   return((pc != NULL) && token_is(pc->type, TKF_PAREN_OPEN));
 }
 
 
 static_inline
 bool chunk_is_paren_close(chunk_t *pc)
 {
-   return((pc != NULL) &&
-          ((pc->type == CT_PAREN_CLOSE) ||
-           (pc->type == CT_SPAREN_CLOSE) ||
-           (pc->type == CT_FPAREN_CLOSE)));
+   return((pc != NULL) && token_is(pc->type, TKF_PAREN_CLOSE));
 }
 
 
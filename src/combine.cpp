@@ -302,8 +302,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
          for (tmp = chunk_get_prev_ncnl(pc); tmp != NULL; tmp = chunk_get_prev_ncnl(tmp))
          {
             if (chunk_is_semicolon(tmp) ||
-                (tmp->type == CT_BRACE_OPEN) ||
-                (tmp->type == CT_VBRACE_OPEN))
+                chunk_is_opening_brace(tmp))
             {
                break;
             }
@@ -1279,20 +1278,22 @@ static chunk_t *process_return(chunk_t *pc)
       {
          temp->level++;
       }
+      chunk_match_changed();
    }
    return(semi);
 }
 
 
-static bool is_ucase_str(const char *str, int len)
+static bool is_ucase_str(const unc_text& str)
 {
-   while (len-- > 0)
+   for (int idx = 0; idx < str.size(); idx++)
    {
-      if (unc_toupper(*str) != *str)
+      /* unc_toupper() only looks at the low byte, so keep to ASCII */
+      int ch = str[idx];
+      if ((ch < 0x80) && (unc_toupper(ch) != ch))
       {
          return(false);
       }
-      str++;
    }
    return(true);
 }
@@ -1411,7 +1412,7 @@ static void fix_casts(chunk_t *start)
       {
          detail = " -- '_t'";
       }
-      else if (is_ucase_str(last->text(), last->len()))
+      else if (is_ucase_str(last->str))
       {
          detail = " -- upper case";
       }
@@ -1763,7 +1764,7 @@ static void fix_typedef(chunk_t *start)
             }
 
             prev->parent_type       = CT_TYPEDEF;
-            open_paren              = chunk_get_prev_type(prev, c_token_t(prev->type - 1), prev->level);
+            open_paren              = chunk_skip_to_match_rev(prev);
             open_paren->parent_type = CT_TYPEDEF;
 
             flag_parens(next, 0, CT_FPAREN_OPEN, CT_TYPEDEF, false);
@@ -2483,6 +2484,27 @@ static bool can_be_full_param(chunk_t *start, chunk_t *end)
 }
 
 
+/**
+ * Finds the last brace open before pc at the given level, which is normally
+ * the one that pc is in. The enclosing brackets are checked first, as that
+ * doesn't need a scan.
+ */
+static chunk_t *get_enclosing_brace(chunk_t *pc, int level)
+{
+   chunk_t *tmp = chunk_get_scope(pc);
+
+   while ((tmp != NULL) && (tmp->level > level))
+   {
+      tmp = chunk_get_scope(tmp);
+   }
+   if ((tmp != NULL) && (tmp->level == level) && (tmp->type == CT_BRACE_OPEN))
+   {
+      return(tmp);
+   }
+   return(chunk_get_prev_type(pc, CT_BRACE_OPEN, level));
+}
+
+
 /**
  * We are on a function word. we need to:
  *  - find out if this is a call or prototype or implementation
@@ -2998,7 +3020,7 @@ static void mark_function(chunk_t *pc)
       }
       else if (pc->brace_level > 0)
       {
-         chunk_t *br_open = chunk_get_prev_type(pc, CT_BRACE_OPEN, pc->brace_level - 1);
+         chunk_t *br_open = get_enclosing_brace(pc, pc->brace_level - 1);
 
          if ((br_open != NULL) &&
              (br_open->parent_type != CT_EXTERN) &&
@@ -3008,11 +3030,9 @@ static void mark_function(chunk_t *pc)
             prev = chunk_get_prev_ncnl(pc);
             if (!chunk_is_str(prev, "*", 1) && !chunk_is_str(prev, "&", 1))
             {
-               chunk_t *p_op = chunk_get_prev_type(pc, CT_BRACE_OPEN, pc->brace_level - 1);
-               if ((p_op != NULL) &&
-                   (p_op->parent_type != CT_CLASS) &&
-                   (p_op->parent_type != CT_STRUCT) &&
-                   (p_op->parent_type != CT_NAMESPACE))
+               if ((br_open->parent_type != CT_CLASS) &&
+                   (br_open->parent_type != CT_STRUCT) &&
+                   (br_open->parent_type != CT_NAMESPACE))
                {
                   pc->type = CT_FUNC_CTOR_VAR;
                   LOG_FMT(LFCN, "  4) Marked [%s] as FUNC_CTOR_VAR on line %d col %d\n",
@@ -3444,16 +3464,13 @@ static void mark_define_expressions(void)
          {
             if ((pc->type != CT_MACRO) &&
                 (first ||
-                 (prev->type == CT_PAREN_OPEN) ||
+                 chunk_is_paren_open(prev) ||
                  (prev->type == CT_ARITH) ||
                  (prev->type == CT_ASSIGN) ||
                  (prev->type == CT_COMPARE) ||
                  (prev->type == CT_RETURN) ||
                  (prev->type == CT_GOTO) ||
                  (prev->type == CT_CONTINUE) ||
-                 (prev->type == CT_PAREN_OPEN) ||
-                 (prev->type == CT_FPAREN_OPEN) ||
-                 (prev->type == CT_SPAREN_OPEN) ||
                  (prev->type == CT_BRACE_OPEN) ||
                  chunk_is_semicolon(prev) ||
                  (prev->type == CT_COMMA) ||
@@ -3836,6 +3853,7 @@ static void mark_exec_sql(chunk_t *pc)
    {
       tmp->level++;
    }
+   chunk_match_changed();
 }
 
 
@@ -22,7 +22,35 @@
 using namespace std;
 
 typedef map<string, string> defmap;
-defmap defines;
+
+struct define_table
+{
+   defmap defs;
+};
+
+/* The defines, unless the context has a table of its own */
+static define_table def_shared;
+
+
+static defmap& def_map(void)
+{
+   return(((cpd.defines != NULL) ? cpd.defines : &def_shared)->defs);
+}
+
+
+/**
+ * Creates an empty define table, for a context that doesn't share the defines
+ */
+define_table *define_table_new(void)
+{
+   return(new define_table());
+}
+
+
+void define_table_delete(define_table *tbl)
+{
+   delete tbl;
+}
 
 
 /**
@@ -39,6 +67,8 @@ void add_define(const char *tag, const char *value)
    }
    value = value ? value : "";
 
+   defmap& defines = def_map();
+
    /* Try to update an existing entry first */
    defmap::iterator it = defines.find(tag);
    if (it != defines.end())
@@ -114,6 +144,8 @@ int load_define_file(const char *filename)
 
 void output_defines(FILE *pfile)
 {
+   defmap& defines = def_map();
+
    if (defines.size() > 0)
    {
       fprintf(pfile, "-== User Defines ==-\n");
@@ -135,6 +167,7 @@ void output_defines(FILE *pfile)
 
 void print_defines(FILE *pfile)
 {
+   defmap&          defines = def_map();
    defmap::iterator it;
    for (it = defines.begin(); it != defines.end(); ++it)
    {
@@ -146,5 +179,5 @@ void print_defines(FILE *pfile)
 
 void clear_defines(void)
 {
-   defines.clear();
+   def_map().clear();
 }
@@ -0,0 +1,479 @@
+/**
+ * @file diff.cpp
+ * Creates a unified diff between the input and the output, for '--diff'.
+ * See diff.h for the details.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "diff.h"
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <string>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#define DIFF_CONTEXT    3
+
+
+struct diff_line
+{
+   const UINT8 *text;
+   size_t      len;      /* including the newline, if there is one */
+   UINT32      hash;
+};
+
+/**
+ * A path through the middle of the edit graph: one edit and a run of
+ * matching lines. A forward snake starts with the edit, a backward snake
+ * ends with it.
+ */
+struct diff_snake
+{
+   int  x0, y0;
+   int  x1, y1;
+   bool forward;
+};
+
+struct diff_ctx
+{
+   vector<diff_line> a;       /* the old lines */
+   vector<diff_line> b;       /* the new lines */
+   vector<bool>      del;     /* the old lines that are removed */
+   vector<bool>      ins;     /* the new lines that are added */
+   vector<int>       vf;      /* furthest x per diagonal, going forward */
+   vector<int>       vb;      /* furthest y per diagonal, going backward */
+};
+
+/* A run of changed lines, old [i0, i1) is replaced by new [j0, j1) */
+struct diff_group
+{
+   int i0, i1;
+   int j0, j1;
+};
+
+
+static bool is_sep(char ch)
+{
+   return((ch == '/') || (ch == PATH_SEP));
+}
+
+
+/**
+ * Gets the name of a file for the diff header, which must be relative so
+ * that 'patch -p1' and 'git apply' find the file after stripping 'a/'.
+ * An absolute path in the current folder is made relative to it. Otherwise
+ * the drive, the leading separators and any './' are dropped.
+ */
+static string diff_name(const char *filename)
+{
+   const char *name = filename;
+
+#ifdef HAVE_UNISTD_H
+   char cwd[4096];
+   if (is_sep(name[0]) && (getcwd(cwd, sizeof(cwd)) != NULL))
+   {
+      size_t len = strlen(cwd);
+      while ((len > 0) && is_sep(cwd[len - 1]))
+      {
+         len--;
+      }
+      if ((strncmp(name, cwd, len) == 0) && is_sep(name[len]))
+      {
+         name += len;
+      }
+   }
+#endif
+
+   if (isalpha((UINT8)name[0]) && (name[1] == ':'))
+   {
+      name += 2;
+   }
+   while (true)
+   {
+      if (is_sep(name[0]))
+      {
+         name++;
+      }
+      else if ((name[0] == '.') && is_sep(name[1]))
+      {
+         name += 2;
+      }
+      else
+      {
+         break;
+      }
+   }
+
+   /* The diff always uses '/' */
+   string out(name);
+   for (size_t idx = 0; idx < out.size(); idx++)
+   {
+      if (out[idx] == PATH_SEP)
+      {
+         out[idx] = '/';
+      }
+   }
+   return(out);
+}
+
+
+static void split_lines(const UINT8 *data, size_t len, vector<diff_line>& lines)
+{
+   size_t start = 0;
+
+   while (start < len)
+   {
+      diff_line   dl;
+      const UINT8 *nl = (const UINT8 *)memchr(data + start, '\n', len - start);
+      size_t      end = (nl != NULL) ? (nl - data) + 1 : len;
+
+      dl.text = data + start;
+      dl.len  = end - start;
+      dl.hash = 2166136261u;
+      for (size_t idx = 0; idx < dl.len; idx++)
+      {
+         dl.hash = (dl.hash ^ dl.text[idx]) * 16777619u;
+      }
+      lines.push_back(dl);
+      start = end;
+   }
+}
+
+
+static bool lines_equal(const diff_ctx& ctx, int x, int y)
+{
+   const diff_line& la = ctx.a[x];
+   const diff_line& lb = ctx.b[y];
+
+   return((la.hash == lb.hash) && (la.len == lb.len) &&
+          (memcmp(la.text, lb.text, la.len) == 0));
+}
+
+
+/**
+ * Finds the middle snake of the box, going forward from the top left and
+ * backward from the bottom right until the two meet.
+ * The box must not start or end with a matching line and must have lines on
+ * both sides.
+ */
+static void find_middle_snake(diff_ctx& ctx, int left, int top,
+                              int right, int bottom, diff_snake& sn)
+{
+   int    delta = (right - left) - (bottom - top);
+   bool   odd   = (delta & 1) != 0;
+   int    dmax  = ((right - left) + (bottom - top) + 1) / 2;
+   size_t vlen  = 2 * dmax + 3;
+
+   if (ctx.vf.size() < vlen)
+   {
+      ctx.vf.resize(vlen);
+      ctx.vb.resize(vlen);
+   }
+
+   /* index by diagonal, which goes from -(dmax + 1) to dmax + 1 */
+   int *vf = &ctx.vf[dmax + 1];
+   int *vb = &ctx.vb[dmax + 1];
+
+   vf[1] = left;
+   vb[1] = bottom;
+
+   /* The two searches always meet by dmax, this just keeps gcc quiet */
+   sn.x0      = left;
+   sn.y0      = top;
+   sn.x1      = right;
+   sn.y1      = bottom;
+   sn.forward = true;
+
+   for (int d = 0; d <= dmax; d++)
+   {
+      /* Forward, diagonal k is x - y */
+      for (int k = d; k >= -d; k -= 2)
+      {
+         int x, px;
+
+         if ((k == -d) || ((k != d) && (vf[k - 1] < vf[k + 1])))
+         {
+            px = x = vf[k + 1];
+         }
+         else
+         {
+            px = vf[k - 1];
+            x  = px + 1;
+         }
+         int y  = top + (x - left) - k;
+         int py = ((d == 0) || (x != px)) ? y : y - 1;
+
+         while ((x < right) && (y < bottom) && lines_equal(ctx, x, y))
+         {
+            x++;
+            y++;
+         }
+         vf[k] = x;
+
+         int c = k - delta;
+         if (odd && (c >= -(d - 1)) && (c <= d - 1) && (y >= vb[c]))
+         {
+            sn.x0      = px;
+            sn.y0      = py;
+            sn.x1      = x;
+            sn.y1      = y;
+            sn.forward = true;
+            return;
+         }
+      }
+
+      /* Backward, diagonal c is k - delta */
+      for (int c = d; c >= -d; c -= 2)
+      {
+         int y, py;
+
+         if ((c == -d) || ((c != d) && (vb[c - 1] > vb[c + 1])))
+         {
+            py = y = vb[c + 1];
+         }
+         else
+         {
+            py = vb[c - 1];
+            y  = py - 1;
+         }
+         int k  = c + delta;
+         int x  = left + (y - top) + k;
+         int px = ((d == 0) || (y != py)) ? x : x + 1;
+
+         while ((x > left) && (y > top) && lines_equal(ctx, x - 1, y - 1))
+         {
+            x--;
+            y--;
+         }
+         vb[c] = y;
+
+         if (!odd && (k >= -d) && (k <= d) && (x <= vf[k]))
+         {
+            sn.x0      = x;
+            sn.y0      = y;
+            sn.x1      = px;
+            sn.y1      = py;
+            sn.forward = false;
+            return;
+         }
+      }
+   }
+}
+
+
+/**
+ * Marks the removed and added lines in a box of the edit graph.
+ */
+static void compare_lines(diff_ctx& ctx, int left, int top, int right, int bottom)
+{
+   /* Skip the matching lines at both ends */
+   while ((left < right) && (top < bottom) && lines_equal(ctx, left, top))
+   {
+      left++;
+      top++;
+   }
+   while ((left < right) && (top < bottom) &&
+          lines_equal(ctx, right - 1, bottom - 1))
+   {
+      right--;
+      bottom--;
+   }
+
+   if (left == right)
+   {
+      while (top < bottom)
+      {
+         ctx.ins[top++] = true;
+      }
+      return;
+   }
+   if (top == bottom)
+   {
+      while (left < right)
+      {
+         ctx.del[left++] = true;
+      }
+      return;
+   }
+
+   diff_snake sn;
+   find_middle_snake(ctx, left, top, right, bottom, sn);
+
+   /* The single edit is at the start of a forward snake and at the end of a
+    * backward snake.
+    */
+   int dx = sn.x1 - sn.x0;
+   int dy = sn.y1 - sn.y0;
+   if (dx > dy)
+   {
+      ctx.del[sn.forward ? sn.x0 : sn.x1 - 1] = true;
+   }
+   else if (dy > dx)
+   {
+      ctx.ins[sn.forward ? sn.y0 : sn.y1 - 1] = true;
+   }
+
+   compare_lines(ctx, left, top, sn.x0, sn.y0);
+   compare_lines(ctx, sn.x1, sn.y1, right, bottom);
+}
+
+
+static void append_text(vector<UINT8>& out, const char *text)
+{
+   out.insert(out.end(), text, text + strlen(text));
+}
+
+
+static void append_line(vector<UINT8>& out, char prefix, const diff_line& dl)
+{
+   out.push_back(prefix);
+   out.insert(out.end(), dl.text, dl.text + dl.len);
+   if ((dl.len == 0) || (dl.text[dl.len - 1] != '\n'))
+   {
+      append_text(out, "\n\\ No newline at end of file\n");
+   }
+}
+
+
+/**
+ * Prints a hunk range. An empty range names the line before it.
+ */
+static void append_range(vector<UINT8>& out, char prefix, int start, int len)
+{
+   char buf[64];
+
+   if (len == 1)
+   {
+      snprintf(buf, sizeof(buf), "%c%d", prefix, start + 1);
+   }
+   else
+   {
+      snprintf(buf, sizeof(buf), "%c%d,%d", prefix,
+               (len == 0) ? start : start + 1, len);
+   }
+   append_text(out, buf);
+}
+
+
+/**
+ * Prints the hunk for groups [first, last], with the context around them.
+ */
+static void append_hunk(const diff_ctx& ctx, const vector<diff_group>& groups,
+                        size_t first, size_t last, vector<UINT8>& out)
+{
+   int a_start = max(groups[first].i0 - DIFF_CONTEXT, 0);
+   int b_start = groups[first].j0 - (groups[first].i0 - a_start);
+   int a_end   = min(groups[last].i1 + DIFF_CONTEXT, (int)ctx.a.size());
+   int b_end   = groups[last].j1 + (a_end - groups[last].i1);
+
+   append_text(out, "@@ ");
+   append_range(out, '-', a_start, a_end - a_start);
+   append_text(out, " ");
+   append_range(out, '+', b_start, b_end - b_start);
+   append_text(out, " @@\n");
+
+   int i = a_start;
+   for (size_t g_idx = first; g_idx <= last; g_idx++)
+   {
+      const diff_group& grp = groups[g_idx];
+
+      for ( ; i < grp.i0; i++)
+      {
+         append_line(out, ' ', ctx.a[i]);
+      }
+      for ( ; i < grp.i1; i++)
+      {
+         append_line(out, '-', ctx.a[i]);
+      }
+      for (int j = grp.j0; j < grp.j1; j++)
+      {
+         append_line(out, '+', ctx.b[j]);
+      }
+   }
+   for ( ; i < a_end; i++)
+   {
+      append_line(out, ' ', ctx.a[i]);
+   }
+}
+
+
+void diff_unified(const char *filename,
+                  const UINT8 *old_data, size_t old_len,
+                  const UINT8 *new_data, size_t new_len,
+                  vector<UINT8>& out)
+{
+   if ((old_len == new_len) &&
+       ((old_len == 0) || (memcmp(old_data, new_data, old_len) == 0)))
+   {
+      return;
+   }
+
+   diff_ctx ctx;
+
+   split_lines(old_data, old_len, ctx.a);
+   split_lines(new_data, new_len, ctx.b);
+   ctx.del.resize(ctx.a.size());
+   ctx.ins.resize(ctx.b.size());
+
+   compare_lines(ctx, 0, 0, ctx.a.size(), ctx.b.size());
+
+   /* Collect the runs of changed lines */
+   vector<diff_group> groups;
+   int                i = 0;
+   int                j = 0;
+   while ((i < (int)ctx.a.size()) || (j < (int)ctx.b.size()))
+   {
+      if (((i < (int)ctx.a.size()) && ctx.del[i]) ||
+          ((j < (int)ctx.b.size()) && ctx.ins[j]))
+      {
+         diff_group grp;
+
+         grp.i0 = i;
+         grp.j0 = j;
+         while ((i < (int)ctx.a.size()) && ctx.del[i])
+         {
+            i++;
+         }
+         while ((j < (int)ctx.b.size()) && ctx.ins[j])
+         {
+            j++;
+         }
+         grp.i1 = i;
+         grp.j1 = j;
+         groups.push_back(grp);
+      }
+      else
+      {
+         i++;
+         j++;
+      }
+   }
+
+   if (groups.empty())
+   {
+      return;
+   }
+
+   string name = diff_name(filename);
+   append_text(out, "--- a/");
+   append_text(out, name.c_str());
+   append_text(out, "\n+++ b/");
+   append_text(out, name.c_str());
+   append_text(out, "\n");
+
+   /* Groups that share context lines go into one hunk */
+   size_t first = 0;
+   for (size_t idx = 1; idx <= groups.size(); idx++)
+   {
+      if ((idx == groups.size()) ||
+          (groups[idx].i0 - groups[idx - 1].i1 > 2 * DIFF_CONTEXT))
+      {
+         append_hunk(ctx, groups, first, idx - 1, out);
+         first = idx;
+      }
+   }
+}
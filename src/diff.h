@@ -0,0 +1,34 @@
+/**
+ * @file diff.h
+ * Creates a unified diff between the input and the output, for '--diff'.
+ *
+ * The lines are compared with the linear space variant of the Myers O(ND)
+ * algorithm, so the cost grows with the number of changed lines rather than
+ * with the size of the file. The hunks have three lines of context, like
+ * 'diff -u', and the file names get the 'a/' and 'b/' prefixes, so the diff
+ * can be applied with 'patch -p1' or 'git apply'.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef DIFF_H_INCLUDED
+#define DIFF_H_INCLUDED
+
+#include "base_types.h"
+#include <vector>
+using namespace std;
+
+
+/**
+ * Appends a unified diff that turns old_data into new_data to out.
+ * Nothing is added if the two are the same.
+ *
+ * @param filename  The file, made relative for the diff header
+ */
+void diff_unified(const char *filename,
+                  const UINT8 *old_data, size_t old_len,
+                  const UINT8 *new_data, size_t new_len,
+                  vector<UINT8>& out);
+
+
+#endif /* DIFF_H_INCLUDED */
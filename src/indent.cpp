@@ -279,27 +279,23 @@ void reindent_line2(chunk_t *pc, int column, const char *fcn_name, int lineno)
  */
 static void indent_pse_push(struct parse_frame& frm, chunk_t *pc)
 {
-   static int ref = 0;
+   static thread_local int ref = 0;
 
-   /* check the stack depth */
-   if (frm.pse_tos < ((int)ARRAY_SIZE(frm.pse) - 1))
-   {
-      /* Bump up the index and initialize it */
-      frm.pse_tos++;
-      memset(&frm.pse[frm.pse_tos], 0, sizeof(frm.pse[frm.pse_tos]));
-
-      LOG_FMT(LINDPSE, "%4d] (pp=%d) OPEN  [%d,%s] level=%d\n",
-              pc->orig_line, cpd.pp_level, frm.pse_tos, get_token_name(pc->type), pc->level);
-
-      frm.pse[frm.pse_tos].pc         = pc;
-      frm.pse[frm.pse_tos].type       = pc->type;
-      frm.pse[frm.pse_tos].level      = pc->level;
-      frm.pse[frm.pse_tos].open_line  = pc->orig_line;
-      frm.pse[frm.pse_tos].ref        = ++ref;
-      frm.pse[frm.pse_tos].in_preproc = (pc->flags & PCF_IN_PREPROC) != 0;
-      frm.pse[frm.pse_tos].indent_tab = frm.pse[frm.pse_tos - 1].indent_tab;
-      frm.pse[frm.pse_tos].non_vardef = false;
-   }
+   /* Bump up the index and initialize it */
+   frm.pse_push();
+   memset(&frm.pse[frm.pse_tos], 0, sizeof(frm.pse[frm.pse_tos]));
+
+   LOG_FMT(LINDPSE, "%4d] (pp=%d) OPEN  [%d,%s] level=%d\n",
+           pc->orig_line, cpd.pp_level, frm.pse_tos, get_token_name(pc->type), pc->level);
+
+   frm.pse[frm.pse_tos].pc         = pc;
+   frm.pse[frm.pse_tos].type       = pc->type;
+   frm.pse[frm.pse_tos].level      = pc->level;
+   frm.pse[frm.pse_tos].open_line  = pc->orig_line;
+   frm.pse[frm.pse_tos].ref        = ++ref;
+   frm.pse[frm.pse_tos].in_preproc = (pc->flags & PCF_IN_PREPROC) != 0;
+   frm.pse[frm.pse_tos].indent_tab = frm.pse[frm.pse_tos - 1].indent_tab;
+   frm.pse[frm.pse_tos].non_vardef = false;
 }
 
 
@@ -401,7 +397,6 @@ void indent_text(void)
    bool               in_func_def = false;
    c_token_t          memtype;
 
-   memset(&frm, 0, sizeof(frm));
    cpd.frame_count = 0;
 
    /* dummy top-level entry */
@@ -715,9 +710,7 @@ void indent_text(void)
 
             /* Close out parens and squares */
             if ((frm.pse[frm.pse_tos].type == (pc->type - 1)) &&
-                ((pc->type == CT_PAREN_CLOSE) ||
-                 (pc->type == CT_SPAREN_CLOSE) ||
-                 (pc->type == CT_FPAREN_CLOSE) ||
+                (chunk_is_paren_close(pc) ||
                  (pc->type == CT_SQUARE_CLOSE) ||
                  (pc->type == CT_ANGLE_CLOSE)))
             {
@@ -1062,9 +1055,7 @@ void indent_text(void)
             }
          }
       }
-      else if ((pc->type == CT_PAREN_OPEN) ||
-               (pc->type == CT_SPAREN_OPEN) ||
-               (pc->type == CT_FPAREN_OPEN) ||
+      else if (chunk_is_paren_open(pc) ||
                (pc->type == CT_SQUARE_OPEN) ||
                (pc->type == CT_ANGLE_OPEN))
       {
@@ -1696,7 +1687,7 @@ static void indent_comment(chunk_t *pc, int col)
 /**
  * Scan to see if the whole file is covered by one #ifdef
  */
-static bool ifdef_over_whole_file()
+bool ifdef_over_whole_file(void)
 {
    chunk_t *pc;
    chunk_t *next;
@@ -1767,8 +1758,9 @@ void indent_preproc(void)
    int     pp_level;
    int     pp_level_sub = 0;
 
-   /* Scan to see if the whole file is covered by one #ifdef */
-   if (ifdef_over_whole_file())
+   /* Scan to see if the whole file is covered by one #ifdef.
+    * With '--lines' that was done before the file was cut down. */
+   if (cpd.lines.empty() ? ifdef_over_whole_file() : cpd.lines_ifdef)
    {
       pp_level_sub = 1;
    }
@@ -0,0 +1,97 @@
+/*
+ * Generated by make_keyword_hash.py from the keywords[] table in keywords.cpp
+ */
+#ifndef KEYWORD_HASH_H_INCLUDED
+#define KEYWORD_HASH_H_INCLUDED
+
+#define KW_HASH_SIZE       1024
+#define KW_HASH_BUCKETS    128
+
+/* The seed of each bucket */
+static const UINT32 kw_hash_seed[KW_HASH_BUCKETS] =
+{
+       1,     1,     1,     1,     1,     2,     1,     1,     1,     1,
+       1,     1,     1,     1,     2,     0,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     0,     2,     1,     0,     1,
+       1,     1,     1,     1,     1,     2,     1,     1,     1,     1,
+       1,     1,     0,     0,     2,     0,     1,     1,     1,     1,
+       0,     1,     1,     0,     1,     1,     1,     1,     2,     1,
+       1,     1,     1,     1,     1,     1,     3,     1,     2,     0,
+       2,     3,     0,     1,     1,     0,     1,     1,     1,     1,
+       0,     1,     1,     1,     1,     1,     2,     1,     1,     1,
+       1,     0,     1,     2,     1,     2,     0,     0,     1,     0,
+       0,     1,     2,     1,     0,     1,     1,     3,     0,     1,
+       3,     0,     1,     1,     1,     1,     2,     1,     2,     1,
+       1,     1,     0,     1,     0,     1,     1,     1,
+};
+
+/* The index in keywords[] of the first entry of the name in each slot, or -1 */
+static const short kw_hash_slot[KW_HASH_SIZE] =
+{
+    -1, 123,  -1,  82,  -1,  -1,  80, 182,  -1,  -1, 215,  -1,  -1,  35,  -1, 103,
+    -1,  -1,  -1,  -1, 146,  -1,  -1,  -1,  -1,  -1,  46,  -1,  -1,  55,  13,  -1,
+    -1,  -1,  -1, 164,  -1,  -1,  -1,  -1,  -1,  -1,  94,  -1,  -1,  -1,  84,  -1,
+    -1, 200,  -1,  -1, 126,  -1,  -1,  -1,  -1,  -1, 212,  -1,  -1,  -1, 105,  -1,
+   206,  -1,  -1,  -1, 116,  -1,  -1, 199,  -1,  -1,  -1,  -1, 162,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  73,
+    -1,  -1,  -1,  64,  -1,  -1,  -1,  28,  -1,  -1, 106,  -1,  -1, 158,  -1,  -1,
+   168,  -1, 173,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  11,  38,  -1,  -1,  39,
+    -1,  47,  -1, 136,  -1,  -1,  -1,  -1,  -1,  50,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 127,   1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 221,  -1,  -1,
+    -1,  -1,  -1, 144,  -1, 195,  -1,  -1, 155,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+   191,  -1,  -1,  -1,  -1,  -1,  -1,  70,  -1,  -1,  -1,  -1,  79, 214,  -1,  -1,
+   217,  -1,  -1,  -1,  -1,  -1, 189,  -1, 154,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+     5,  -1,  -1,   2,  74,  -1,  -1,  -1, 178,  -1,  -1, 209,   0,  -1,  88,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  75,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  10,  -1,  -1,  -1, 192,  -1,  -1,  -1,  -1,  -1, 184,  -1, 218,  -1,
+    -1,  -1,  -1,  -1,  -1,  95,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  83,  41,  -1,  -1,  -1,  -1,  -1, 130, 179,  62,  -1,  -1,  99,  -1,  -1,
+    -1,  -1,  -1,  -1, 180, 102,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 174,  -1,  -1,
+    17, 129, 205,  -1,  -1,  -1,  -1,  -1,  -1, 211,  -1,  60,  -1,  -1, 124,  -1,
+    -1,  -1, 117,  -1,  27,  -1,  -1, 194, 111,  -1,  -1,  -1,  -1,  -1,  -1,  59,
+    51,  -1,  16,  -1,  -1,   8,  -1, 118,  -1,  -1,  -1,  65, 133,  -1,  -1,  -1,
+    -1,  48,  -1,  -1,  -1,  22,  -1,  90,  -1,  -1,  -1,  89,  -1,  -1,  31,  -1,
+    93,  -1,  -1,  -1,  -1,  -1, 225,  -1,  23,  -1, 159,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1, 139,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 222,  -1, 198,  -1,
+    -1,  -1,  -1,  -1,  78,  -1,  25,  -1,  -1,  -1,  -1, 165,  -1,  -1,  -1,  -1,
+    -1,  -1, 108, 132,  -1,  -1,  -1,  -1,  -1,  -1,  67,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  98,  -1,  -1,  -1,  -1,  -1,  -1,   4,  -1,  -1,  -1,  77,
+   110,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  58,  -1, 156,  12,  -1,  -1,  -1,
+    86,  -1,  -1,  -1,  -1, 107,  -1,  91, 148,  -1,  -1,  -1,  -1,  -1, 163,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 210, 171, 161,  -1,
+   138,  -1, 183,  -1,  -1, 204,  -1,  -1,  -1,  -1, 226,  -1,  -1, 120,  -1,  -1,
+   151,  -1,  -1, 152,  -1,  -1,  -1, 137,  -1,  54,  -1,  -1,  -1,  -1,  -1,  -1,
+    33, 101,  -1,  -1,  -1,  -1,  -1, 185,  -1,  -1,  -1,  -1,  -1, 208,  -1,  -1,
+   187,  -1,  -1,  -1,  -1, 114,  69,  -1,  30,  -1,  -1,  -1, 113,  -1,  -1,  57,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1, 142,  -1,  -1, 181,   7,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1, 176,  -1,  -1,  -1, 197,  -1,  -1, 121,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 135,  -1,  63,  -1,
+    -1,  -1,  -1,  85,  -1,  -1,  -1,  -1,  -1, 175,  -1,  -1,  -1,  -1,  -1,  -1,
+   186,  42,  -1,  -1,  -1,  -1, 166,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   9,  -1,
+    -1,  -1,  20,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  52,  -1,
+    -1, 140,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  40,  -1,  -1,
+    -1,  -1,  -1, 172,  -1,  -1,  18,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    14,  -1,  -1,  -1, 125,  -1,  -1,  -1,  -1, 160, 203,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  44,  -1,  -1, 188,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  97,
+    -1,  -1,  34,  -1, 170,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 100,
+    -1,  -1,  -1,  -1, 196,  -1,  -1,  -1,  -1,  -1,  -1, 193,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1, 224,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  49, 115,  -1, 190, 109,  -1,  -1,  -1,  -1,  -1, 223,
+    -1, 143,  92,  -1,  -1,  -1, 213,  -1,  -1,  -1,  -1,  71,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1, 220,  -1,  -1,  -1,  53,  -1,  -1,  -1,  -1,   3,  -1, 157,  -1,  -1,
+    24,  -1,  -1,  -1,  -1,  -1,  -1, 145,  96, 201,  -1,  -1,   6,  -1,  -1,  -1,
+    -1,  -1,  61,  87,  -1,  -1,  -1,  -1, 207,  -1,  29,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  26,  -1,  -1,  -1,  -1, 134,  -1,  -1,  -1,  45,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1, 150,  -1,  -1, 104,  -1, 128,  -1,  -1,  -1,  -1,
+    -1,  -1, 216,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  15,  -1,  -1, 153, 169,
+   177,  -1,  -1,  -1,  -1,  -1,  -1,  68,  -1,  -1,  66,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1, 122,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  19,  -1,  -1,  43, 202,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  21,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+    -1,  -1,  -1,  -1, 149, 167,  76,  -1,  -1, 147,  -1, 131,  -1,  -1,  -1,  32,
+};
+
+#endif /* KEYWORD_HASH_H_INCLUDED */
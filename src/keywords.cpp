@@ -12,19 +12,234 @@
 #include <cstring>
 #include <cerrno>
 #include <cstdlib>
-#include <map>
+#include <algorithm>
+#include <atomic>
 #include "unc_ctype.h"
+#include "keyword_hash.h"
 
 using namespace std;
 
-/* Dynamic keyword map */
-typedef map<string, c_token_t> dkwmap;
-static dkwmap dkwm;
+/* This must match kw_hash() in scripts/make_keyword_hash.py */
+static UINT32 kw_hash(const char *word, int len)
+{
+   UINT32 h = 2166136261u;
+
+   for (int idx = 0; idx < len; idx++)
+   {
+      h = (h ^ (UINT8)word[idx]) * 16777619u;
+   }
+   return(h);
+}
+
+
+/**
+ * The dynamic keywords, from the config and the type files.
+ * The names are kept one after the other in 'names' and the slots are an
+ * open addressing hash of the entry numbers + 1, which is kept at most half
+ * full. A lookup doesn't allocate anything.
+ */
+struct dkw_table
+{
+   struct entry
+   {
+      UINT32    offset;   /* of the name in 'names', which ends with a 0 */
+      int       len;
+      UINT32    hash;
+      c_token_t type;
+   };
+
+   vector<char>   names;
+   vector<entry>  entries;
+   vector<UINT32> slots;
+   UINT32         gen;      /* changes with the names, never 0 */
+
+   dkw_table() : gen(next_gen())
+   {
+   }
+
+   bool empty() const
+   {
+      return(entries.empty());
+   }
+
+   const char *name(const entry& ent) const
+   {
+      return(&names[ent.offset]);
+   }
+
+   /**
+    * Finds the slot of a name, which is empty if the name isn't there
+    */
+   UINT32 find_slot(const char *word, int len, UINT32 h) const
+   {
+      UINT32 mask = slots.size() - 1;
+      UINT32 slot = h & mask;
+
+      while (slots[slot] != 0)
+      {
+         const entry& ent = entries[slots[slot] - 1];
+         if ((ent.hash == h) && (ent.len == len) &&
+             (memcmp(name(ent), word, len) == 0))
+         {
+            break;
+         }
+         slot = (slot + 1) & mask;
+      }
+      return(slot);
+   }
+
+   const entry *find(const char *word, int len) const
+   {
+      if (entries.empty())
+      {
+         return(NULL);
+      }
+      UINT32 slot = find_slot(word, len, kw_hash(word, len));
+      return((slots[slot] != 0) ? &entries[slots[slot] - 1] : NULL);
+   }
+
+   /**
+    * Makes room for count more names, so that loading a big type file
+    * doesn't grow the table over and over.
+    */
+   void reserve(size_t count, size_t name_bytes)
+   {
+      entries.reserve(entries.size() + count);
+      names.reserve(names.size() + name_bytes);
+
+      size_t want = slots.empty() ? 64 : slots.size();
+      while (want < (entries.size() + count) * 2)
+      {
+         want *= 2;
+      }
+      if (want != slots.size())
+      {
+         rehash(want);
+      }
+   }
+
+   void rehash(size_t size)
+   {
+      slots.assign(size, 0);
+      UINT32 mask = size - 1;
+      for (size_t idx = 0; idx < entries.size(); idx++)
+      {
+         UINT32 slot = entries[idx].hash & mask;
+         while (slots[slot] != 0)
+         {
+            slot = (slot + 1) & mask;
+         }
+         slots[slot] = idx + 1;
+      }
+   }
+
+   /**
+    * Adds a name or changes its type
+    *
+    * @return false if the name was already there
+    */
+   bool add(const char *word, c_token_t type)
+   {
+      int    len = strlen(word);
+      UINT32 h   = kw_hash(word, len);
+
+      gen = next_gen();
+
+      if ((entries.size() + 1) * 2 > slots.size())
+      {
+         rehash(slots.empty() ? 64 : slots.size() * 2);
+      }
+
+      UINT32 slot = find_slot(word, len, h);
+      if (slots[slot] != 0)
+      {
+         entries[slots[slot] - 1].type = type;
+         return(false);
+      }
+
+      entry ent;
+      ent.offset = names.size();
+      ent.len    = len;
+      ent.hash   = h;
+      ent.type   = type;
+      names.insert(names.end(), word, word + len + 1);
+      entries.push_back(ent);
+      slots[slot] = entries.size();
+      return(true);
+   }
+
+   void clear()
+   {
+      names.clear();
+      entries.clear();
+      slots.clear();
+      gen = next_gen();
+   }
+
+   /**
+    * Gets a number that no table has had before, so that the cached keyword
+    * types of one table are never taken for those of another.
+    * The configs of the library and server threads may load their tables at
+    * the same time.
+    */
+   static UINT32 next_gen()
+   {
+      static atomic<UINT32> last_gen;
+
+      return(++last_gen);
+   }
+
+   /**
+    * Gets the entries sorted by name, for printing
+    */
+   void sorted(vector<const entry *>& out) const;
+};
+
+/* The dynamic keywords, unless the context has a table of its own */
+static dkw_table dkw_shared;
+
+
+static dkw_table& dkw_active(void)
+{
+   return((cpd.keywords != NULL) ? *cpd.keywords : dkw_shared);
+}
+
+
+/**
+ * Creates an empty keyword table, for a context that doesn't share the
+ * dynamic keywords
+ */
+dkw_table *keyword_table_new(void)
+{
+   return(new dkw_table());
+}
+
+
+void keyword_table_delete(dkw_table *tbl)
+{
+   delete tbl;
+}
+
+
+/**
+ * The keyword type of an interned word, by symbol number * 2 + in_pp.
+ * It is only valid for the dynamic keyword table gen and language it was
+ * found with.
+ */
+struct kw_cache_entry
+{
+   UINT32    gen;
+   int       lang_flags;
+   c_token_t type;
+};
+static thread_local vector<kw_cache_entry> kw_cache;
 
 
 /**
  * interesting static keywords - keep sorted.
  * Table should include the Name, Type, and Language flags.
+ * Run scripts/make_keyword_hash.py after changing it, to update the perfect
+ * hash in keyword_hash.h. run_tests.sh checks that it is up to date.
  */
 static const chunk_tag_t keywords[] =
 {
@@ -303,57 +518,43 @@ bool keywords_are_sorted(void)
  */
 void add_keyword(const char *tag, c_token_t type)
 {
-   string ss = tag;
-
-   /* See if the keyword has already been added */
-   dkwmap::iterator it = dkwm.find(ss);
-   if (it != dkwm.end())
+   if (dkw_active().add(tag, type))
+   {
+      LOG_FMT(LDYNKW, "%s: added '%s' as %d\n", __func__, tag, type);
+   }
+   else
    {
       LOG_FMT(LDYNKW, "%s: changed '%s' to %d\n", __func__, tag, type);
-      (*it).second = type;
-      return;
    }
-
-   /* Insert the keyword */
-   dkwm.insert(dkwmap::value_type(ss, type));
-   LOG_FMT(LDYNKW, "%s: added '%s' as %d\n", __func__, tag, type);
 }
 
 
 /**
- * Backs up to the first string match in keywords.
+ * Whether the keywords that are only used in preprocessor directives apply
  */
-static const chunk_tag_t *kw_static_first(const chunk_tag_t *tag)
+static bool kw_in_pp(void)
 {
-   const chunk_tag_t *prev = tag - 1;
-
-   while ((prev >= &keywords[0]) && (strcmp(prev->tag, tag->tag) == 0))
-   {
-      tag = prev;
-      prev--;
-   }
-   //fprintf(stderr, "first:%s -", tag->tag);
-   return(tag);
+   return((cpd.in_preproc != CT_NONE) && (cpd.in_preproc != CT_PP_DEFINE));
 }
 
 
-static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag)
+/**
+ * Finds the entry for the language and preprocessor state among the entries
+ * with the same name, which start at tag.
+ */
+static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag, int lang_flags, bool in_pp)
 {
-   bool              in_pp = ((cpd.in_preproc != CT_NONE) && (cpd.in_preproc != CT_PP_DEFINE));
    bool              pp_iter;
    const chunk_tag_t *iter;
 
-   for (iter = kw_static_first(tag);
-        iter < &keywords[ARRAY_SIZE(keywords)];
+   for (iter = tag;
+        (iter < &keywords[ARRAY_SIZE(keywords)]) && (strcmp(iter->tag, tag->tag) == 0);
         iter++)
    {
-      //fprintf(stderr, " check:%s", iter->tag);
       pp_iter = (iter->lang_flags & FLAG_PP) != 0;
-      if ((strcmp(iter->tag, tag->tag) == 0) &&
-          ((cpd.lang_flags & iter->lang_flags) != 0) &&
+      if (((lang_flags & iter->lang_flags) != 0) &&
           (in_pp == pp_iter))
       {
-         //fprintf(stderr, " match:%s", iter->tag);
          return(iter);
       }
    }
@@ -361,6 +562,56 @@ static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag)
 }
 
 
+/* Spreads a word hash that is changed by a bucket seed over the slots.
+ * This must match kw_slot() in scripts/make_keyword_hash.py. */
+static UINT32 kw_slot(UINT32 h, UINT32 seed)
+{
+   h ^= seed;
+   h ^= h >> 16;
+   h *= 0x85ebca6bu;
+   h ^= h >> 13;
+   h *= 0xc2b2ae35u;
+   h ^= h >> 16;
+   return(h & (KW_HASH_SIZE - 1));
+}
+
+
+/**
+ * The keyword type of each slot for a language, outside and inside of
+ * preprocessor directives. Each thread works it out again when the language
+ * changes.
+ */
+struct kw_lang_table
+{
+   int       lang_flags;
+   c_token_t type[KW_HASH_SIZE][2];
+
+   kw_lang_table() : lang_flags(-1)
+   {
+   }
+
+   void update()
+   {
+      lang_flags = cpd.lang_flags;
+      for (int idx = 0; idx < KW_HASH_SIZE; idx++)
+      {
+         for (int pp = 0; pp < 2; pp++)
+         {
+            const chunk_tag_t *tag = NULL;
+
+            if (kw_hash_slot[idx] >= 0)
+            {
+               tag = kw_static_match(&keywords[kw_hash_slot[idx]], lang_flags, pp != 0);
+            }
+            type[idx][pp] = (tag != NULL) ? tag->type : CT_WORD;
+         }
+      }
+   }
+};
+
+static thread_local kw_lang_table kw_lang;
+
+
 /**
  * Search first the dynamic and then the static table for a matching keyword
  *
@@ -370,32 +621,103 @@ static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag)
  */
 c_token_t find_keyword_type(const char *word, int len)
 {
-   string            ss(word, len);
-   chunk_tag_t       key;
-   const chunk_tag_t *p_ret;
-
    if (len <= 0)
    {
       return(CT_NONE);
    }
 
    /* check the dynamic word list first */
-   dkwmap::iterator it = dkwm.find(ss);
-   if (it != dkwm.end())
+   const dkw_table::entry *ent = dkw_active().find(word, len);
+   if (ent != NULL)
+   {
+      return(ent->type);
+   }
+
+   /* check the static word list, a word can only be the name in its slot */
+   UINT32 h    = kw_hash(word, len);
+   UINT32 sidx = kw_slot(h, kw_hash_seed[h % KW_HASH_BUCKETS]);
+   int    kidx = kw_hash_slot[sidx];
+
+   if ((kidx < 0) ||
+       (strncmp(keywords[kidx].tag, word, len) != 0) ||
+       (keywords[kidx].tag[len] != 0))
+   {
+      return(CT_WORD);
+   }
+   if (kw_lang.lang_flags != cpd.lang_flags)
+   {
+      kw_lang.update();
+   }
+   return(kw_lang.type[sidx][kw_in_pp() ? 1 : 0]);
+}
+
+
+/**
+ * Looks up the chars of a word, which are encoded as UTF-8 into a reused
+ * buffer, so that the log text of the word is not built.
+ */
+static c_token_t find_keyword_type_chars(const unc_text& word)
+{
+   static thread_local vector<UINT8> buf;
+
+   buf.clear();
+   for (int idx = 0; idx < word.size(); idx++)
+   {
+      int ch = word[idx];
+      if (ch < 0x80)
+      {
+         buf.push_back((UINT8)ch);
+      }
+      else
+      {
+         encode_utf8(ch, buf);
+      }
+   }
+   if (buf.empty())
    {
-      return((*it).second);
+      return(CT_NONE);
    }
+   return(find_keyword_type((const char *)&buf[0], (int)buf.size()));
+}
+
 
-   key.tag = ss.c_str();
+/**
+ * Same as above for a whole word, which is looked up once per symbol.
+ */
+c_token_t find_keyword_type(unc_text& word)
+{
+   UINT32 sym = word.sym();
+
+   if (sym == 0)
+   {
+      return(find_keyword_type_chars(word));
+   }
 
-   /* check the static word list */
-   p_ret = (const chunk_tag_t *)bsearch(&key, keywords, ARRAY_SIZE(keywords),
-                                        sizeof(keywords[0]), kw_compare);
-   if (p_ret != NULL)
+   size_t idx = sym * 2 + (kw_in_pp() ? 1 : 0);
+   if (idx >= kw_cache.size())
    {
-      p_ret = kw_static_match(p_ret);
+      kw_cache.resize(idx * 2 + 2);
    }
-   return((p_ret != NULL) ? p_ret->type : CT_WORD);
+
+   UINT32          gen = dkw_active().gen;
+   kw_cache_entry& ent = kw_cache[idx];
+   if ((ent.gen != gen) || (ent.lang_flags != cpd.lang_flags))
+   {
+      ent.gen        = gen;
+      ent.lang_flags = cpd.lang_flags;
+      ent.type       = find_keyword_type_chars(word);
+   }
+   return(ent.type);
+}
+
+
+/**
+ * Forgets the keyword types of the interned words.
+ * Must be called when the symbol table is cleared.
+ */
+void clear_keyword_cache(void)
+{
+   kw_cache.clear();
 }
 
 
@@ -408,7 +730,6 @@ c_token_t find_keyword_type(const char *word, int len)
 int load_keyword_file(const char *filename)
 {
    FILE *pf;
-   char buf[256];
    char *ptr;
    char *args[3];
    int  argc;
@@ -423,17 +744,34 @@ int load_keyword_file(const char *filename)
       return(FAILURE);
    }
 
-   while (fgets(buf, sizeof(buf), pf) != NULL)
+   /* Read it all, so that the table can be sized for all the names at once */
+   vector<char> data;
+   char         buf[4096];
+   size_t       got;
+   while ((got = fread(buf, 1, sizeof(buf), pf)) > 0)
+   {
+      data.insert(data.end(), buf, buf + got);
+   }
+   fclose(pf);
+   data.push_back('\n');
+
+   dkw_active().reserve(count(data.begin(), data.end(), '\n'), data.size());
+
+   char *line = &data[0];
+   char *end  = line + data.size();
+   while (line < end)
    {
+      char *eol = (char *)memchr(line, '\n', end - line);
+      *eol = 0;
       line_no++;
 
       /* remove comments */
-      if ((ptr = strchr(buf, '#')) != NULL)
+      if ((ptr = strchr(line, '#')) != NULL)
       {
          *ptr = 0;
       }
 
-      argc       = Args::SplitLine(buf, args, ARRAY_SIZE(args) - 1);
+      argc       = Args::SplitLine(line, args, ARRAY_SIZE(args) - 1);
       args[argc] = 0;
 
       if (argc > 0)
@@ -449,21 +787,50 @@ int load_keyword_file(const char *filename)
             cpd.error_count++;
          }
       }
+      line = eol + 1;
    }
-
-   fclose(pf);
    return(SUCCESS);
 }
 
 
+struct dkw_name_less
+{
+   const dkw_table *tbl;
+
+   bool operator()(const dkw_table::entry *e1, const dkw_table::entry *e2) const
+   {
+      return(strcmp(tbl->name(*e1), tbl->name(*e2)) < 0);
+   }
+};
+
+
+void dkw_table::sorted(vector<const entry *>& out) const
+{
+   dkw_name_less less;
+
+   less.tbl = this;
+   out.clear();
+   for (size_t idx = 0; idx < entries.size(); idx++)
+   {
+      out.push_back(&entries[idx]);
+   }
+   sort(out.begin(), out.end(), less);
+}
+
+
 void output_types(FILE *pfile)
 {
-   if (dkwm.size() > 0)
+   const dkw_table& dkwm = dkw_active();
+
+   if (!dkwm.empty())
    {
+      vector<const dkw_table::entry *> list;
+
+      dkwm.sorted(list);
       fprintf(pfile, "-== User Types ==-\n");
-      for (dkwmap::iterator it = dkwm.begin(); it != dkwm.end(); ++it)
+      for (size_t idx = 0; idx < list.size(); idx++)
       {
-         fprintf(pfile, "%s\n", (*it).first.c_str());
+         fprintf(pfile, "%s\n", dkwm.name(*list[idx]));
       }
    }
 }
@@ -471,35 +838,41 @@ void output_types(FILE *pfile)
 
 void print_keywords(FILE *pfile)
 {
-   for (dkwmap::iterator it = dkwm.begin(); it != dkwm.end(); ++it)
+   const dkw_table&                 dkwm = dkw_active();
+   vector<const dkw_table::entry *> list;
+
+   dkwm.sorted(list);
+   for (size_t idx = 0; idx < list.size(); idx++)
    {
-      c_token_t tt = (*it).second;
+      c_token_t  tt   = list[idx]->type;
+      const char *tag = dkwm.name(*list[idx]);
+
       if (tt == CT_TYPE)
       {
          fprintf(pfile, "type %*.s%s\n",
-                 cpd.max_option_name_len - 4, " ", (*it).first.c_str());
+                 cpd.max_option_name_len - 4, " ", tag);
       }
       else if (tt == CT_MACRO_OPEN)
       {
          fprintf(pfile, "macro-open %*.s%s\n",
-                 cpd.max_option_name_len - 11, " ", (*it).first.c_str());
+                 cpd.max_option_name_len - 11, " ", tag);
       }
       else if (tt == CT_MACRO_CLOSE)
       {
          fprintf(pfile, "macro-close %*.s%s\n",
-                 cpd.max_option_name_len - 12, " ", (*it).first.c_str());
+                 cpd.max_option_name_len - 12, " ", tag);
       }
       else if (tt == CT_MACRO_ELSE)
       {
          fprintf(pfile, "macro-else %*.s%s\n",
-                 cpd.max_option_name_len - 11, " ", (*it).first.c_str());
+                 cpd.max_option_name_len - 11, " ", tag);
       }
       else
       {
          const char *tn = get_token_name(tt);
 
          fprintf(pfile, "set %s %*.s%s\n", tn,
-                 int(cpd.max_option_name_len - (4 + strlen(tn))), " ", (*it).first.c_str());
+                 int(cpd.max_option_name_len - (4 + strlen(tn))), " ", tag);
       }
    }
 }
@@ -507,7 +880,7 @@ void print_keywords(FILE *pfile)
 
 void clear_keyword_file(void)
 {
-   dkwm.clear();
+   dkw_active().clear();
 }
 
 
@@ -17,16 +17,14 @@ static chunk_t *pawn_process_func_def(chunk_t *pc);
 
 chunk_t *pawn_add_vsemi_after(chunk_t *pc)
 {
-   if ((pc->type == CT_VSEMICOLON) ||
-       (pc->type == CT_SEMICOLON))
+   if (chunk_is_semicolon(pc))
    {
       return(pc);
    }
 
    chunk_t *next = chunk_get_next_nc(pc);
    if ((next != NULL) &&
-       ((next->type == CT_VSEMICOLON) ||
-        (next->type == CT_SEMICOLON)))
+       chunk_is_semicolon(next))
    {
       return(pc);
    }
@@ -105,8 +103,7 @@ static bool pawn_continued(chunk_t *pc, int br_level)
        (pc->type == CT_DO) ||
        (pc->type == CT_SWITCH) ||
        (pc->type == CT_WHILE) ||
-       (pc->type == CT_BRACE_OPEN) ||
-       (pc->type == CT_VBRACE_OPEN) ||
+       chunk_is_opening_brace(pc) ||
        (pc->type == CT_FPAREN_OPEN) ||
        (pc->parent_type == CT_IF) ||
        (pc->parent_type == CT_ELSE) ||
@@ -254,8 +251,7 @@ static chunk_t *pawn_process_variable(chunk_t *start)
       if ((pc->type == CT_NEWLINE) &&
           !pawn_continued(prev, start->level))
       {
-         if ((prev->type != CT_VSEMICOLON) &&
-             (prev->type != CT_SEMICOLON))
+         if (!chunk_is_semicolon(prev))
          {
             pawn_add_vsemi_after(prev);
          }
@@ -281,15 +277,13 @@ void pawn_add_virtual_semicolons(void)
       {
          if (!chunk_is_comment(pc) &&
              !chunk_is_newline(pc) &&
-             (pc->type != CT_VBRACE_CLOSE) &&
-             (pc->type != CT_VBRACE_OPEN))
+             !chunk_is_vbrace(pc))
          {
             prev = pc;
          }
          if ((prev == NULL) ||
              ((pc->type != CT_NEWLINE) &&
-              (pc->type != CT_BRACE_CLOSE) &&
-              (pc->type != CT_VBRACE_CLOSE)))
+              !chunk_is_closing_brace(pc)))
          {
             continue;
          }
@@ -297,8 +291,7 @@ void pawn_add_virtual_semicolons(void)
          /* we just hit a newline and we have a previous token */
          if (((prev->flags & PCF_IN_PREPROC) == 0) &&
              ((prev->flags & (PCF_IN_ENUM | PCF_IN_STRUCT)) == 0) &&
-             (prev->type != CT_VSEMICOLON) &&
-             (prev->type != CT_SEMICOLON) &&
+             !chunk_is_semicolon(prev) &&
              !pawn_continued(prev, prev->brace_level))
          {
             pawn_add_vsemi_after(prev);
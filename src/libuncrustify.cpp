@@ -0,0 +1,156 @@
+/**
+ * @file libuncrustify.cpp
+ * The in-process interface, see libuncrustify.h.
+ *
+ * Each config is loaded into a context of its own, which is copied into the
+ * formatting context of the calling thread when that thread switches configs.
+ * The context has its own keyword and define tables, so the 'type', 'define',
+ * 'macro-open', etc entries of one config don't show up in another.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "libuncrustify.h"
+#include "uncrustify_types.h"
+#include "prototypes.h"
+#include "logger.h"
+#include <cstdio>
+#include <map>
+#include <string>
+#include <mutex>
+#include <shared_mutex>
+
+
+/**
+ * Held exclusively while loading a config, as that changes lib_configs, and
+ * shared while formatting.
+ */
+static shared_mutex lib_lock;
+
+/* The loaded configs, by filename */
+static map<string, cp_data *> lib_configs;
+
+static bool lib_initialized;
+
+/* The config that the context of this thread was copied from */
+static thread_local const cp_data *lib_current;
+
+
+static const cp_data *lib_find_config(const char *cfg_file)
+{
+   map<string, cp_data *>::const_iterator it = lib_configs.find(cfg_file);
+
+   return((it != lib_configs.end()) ? it->second : NULL);
+}
+
+
+/**
+ * Loads a config into a new context.
+ * Must be called with lib_lock held exclusively.
+ * This uses the formatting context of the calling thread.
+ *
+ * @return The loaded config or NULL on failure
+ */
+static const cp_data *lib_load_config(const char *cfg_file)
+{
+   const cp_data *found = lib_find_config(cfg_file);
+
+   if (found != NULL)
+   {
+      return(found);
+   }
+
+   if (!lib_initialized)
+   {
+      log_init(stderr);
+      register_options();
+      lib_initialized = true;
+   }
+
+   cp_data *cfg = new cp_data();
+
+   /* Start from a clean context, like the command line does */
+   lib_current = NULL;
+   cpd         = *cfg;
+   set_option_defaults();
+
+   cpd.filename = cfg_file;
+   cpd.keywords = keyword_table_new();
+   cpd.defines  = define_table_new();
+   if (load_option_file(cfg_file) < 0)
+   {
+      LOG_FMT(LERR, "%s: unable to load the config file %s\n",
+              __func__, cfg_file);
+      keyword_table_delete(cpd.keywords);
+      define_table_delete(cpd.defines);
+      cpd.keywords = NULL;
+      cpd.defines  = NULL;
+      delete cfg;
+      return(NULL);
+   }
+
+   /* This relies on cpd.filename being the config file name */
+   load_header_files();
+
+   *cfg = cpd;
+   lib_configs[cfg_file] = cfg;
+   lib_current           = cfg;
+   return(cfg);
+}
+
+
+int uncrustify_language(const char *tag)
+{
+   return(language_from_tag(tag));
+}
+
+
+int uncrustify_format(const char *cfg_file, int lang,
+                      const uint8_t *in, size_t len,
+                      vector<uint8_t>& out)
+{
+   const cp_data *cfg;
+
+   out.clear();
+
+   {
+      shared_lock<shared_mutex> guard(lib_lock);
+      cfg = lib_find_config(cfg_file);
+   }
+   if (cfg == NULL)
+   {
+      unique_lock<shared_mutex> guard(lib_lock);
+      cfg = lib_load_config(cfg_file);
+      if (cfg == NULL)
+      {
+         return(-1);
+      }
+   }
+
+   shared_lock<shared_mutex> guard(lib_lock);
+
+   if (lib_current != cfg)
+   {
+      cpd         = *cfg;
+      lib_current = cfg;
+   }
+
+   /* The input outlives fm, so fm refers to it like to a mapped file */
+   file_mem fm;
+   if (len > 0)
+   {
+      fm.map.reset(in, [](const UINT8 *) {});
+      fm.map_len = len;
+   }
+   if (!decode_file(fm))
+   {
+      return(-1);
+   }
+
+   cpd.lang_flags = (lang != 0) ? lang : (int)LANG_C;
+   cpd.filename   = "memory";
+
+   UINT32 errors = cpd.error_count;
+   uncrustify_file(fm, &out, NULL);
+   return(cpd.error_count - errors);
+}
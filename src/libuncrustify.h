@@ -0,0 +1,60 @@
+/**
+ * @file libuncrustify.h
+ * Formats source code held in memory, without starting a process or going
+ * through temporary files.
+ *
+ * Link with libuncrustify.a and -lpthread.
+ *
+ *    std::vector<uint8_t> out;
+ *    int lang = uncrustify_language("CPP");
+ *    if (uncrustify_format("my.cfg", lang, text, text_len, out) == 0)
+ *    {
+ *       ... use out ...
+ *    }
+ *
+ * A config is loaded the first time it is used and is then kept for the
+ * life of the process. Any number of threads may call uncrustify_format()
+ * at the same time. The 'type', 'define', 'macro-open', etc entries of a
+ * config only apply to the code formatted with that config.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef LIBUNCRUSTIFY_H_INCLUDED
+#define LIBUNCRUSTIFY_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+
+/**
+ * Looks up a language tag, as used with the '-l' option.
+ *
+ * @param tag  The tag, ie "C", "CPP", "D", "CS", "JAVA", "OC", "OC+", etc
+ * @return     The language to pass to uncrustify_format() or 0 if unknown
+ */
+int uncrustify_language(const char *tag);
+
+
+/**
+ * Formats a buffer of source code.
+ * The input may be in any of the encodings that uncrustify can read and the
+ * output is in the same encoding, unless the config says otherwise.
+ *
+ * @param cfg_file  The config file to use
+ * @param lang      The language from uncrustify_language() or 0 for C
+ * @param in        The source code
+ * @param len       The number of bytes at in
+ * @param out       Receives the formatted source code
+ * @return          0 on success,
+ *                  -1 if the config could not be loaded or the input could not
+ *                  be decoded (out is empty),
+ *                  otherwise the number of errors reported while formatting
+ */
+int uncrustify_format(const char *cfg_file, int lang,
+                      const uint8_t *in, size_t len,
+                      std::vector<uint8_t>& out);
+
+
+#endif /* LIBUNCRUSTIFY_H_INCLUDED */
@@ -0,0 +1,317 @@
+/**
+ * @file lines.cpp
+ * Cuts the chunk list down to the regions that hold the '--lines' ranges.
+ *
+ * The file is split into top-level units, each a declaration, a function,
+ * a preprocessor line or a run of comments, including the blank lines after
+ * it. Units that may be aligned together are grouped. The groups that overlap
+ * a range are the regions that are output, the groups next to a region are
+ * kept so that the region is formatted the same as in the whole file, and
+ * everything else is deleted before the formatting passes run.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "uncrustify_types.h"
+#include "prototypes.h"
+#include "chunk_list.h"
+
+
+struct lines_unit
+{
+   chunk_t *first;
+   chunk_t *last;       /* the newline that ends it, or the last chunk */
+   int     first_line;
+   int     last_line;
+   int     gap;         /* the line breaks after the last token */
+   bool    braces;      /* has a multi-line brace pair at level 0 */
+};
+
+struct lines_group
+{
+   int  first;          /* index of the first unit */
+   int  last;           /* index of the last unit */
+   bool selected;       /* overlaps a '--lines' range */
+   bool keep;           /* selected or next to one */
+};
+
+
+/**
+ * The align spans that can reach from one top-level unit into the next.
+ */
+static const uncrustify_options lines_spans[] =
+{
+   UO_align_var_def_span,
+   UO_align_var_struct_span,
+   UO_align_assign_span,
+   UO_align_enum_equ_span,
+   UO_align_struct_init_span,
+   UO_align_right_cmt_span,
+   UO_align_func_proto_span,
+   UO_align_typedef_span,
+   UO_align_pp_define_span,
+   UO_align_oc_msg_spec_span,
+   UO_align_oc_msg_colon_span,
+};
+
+
+/**
+ * Checks whether a newline ends a top-level unit.
+ * That is a newline at level 0 after a preprocessor line, a ';' or the
+ * closing brace of a function or namespace, where the next line starts a
+ * statement or a preprocessor line. The passes track the #if blocks from the
+ * #if on, so the newline must not be in one that is deeper than pp_max.
+ * The file header and footer have their own line numbers, so a newline that
+ * is inserted or before first_line doesn't count.
+ */
+static bool lines_is_unit_end(chunk_t *nl, int pp_max, int first_line)
+{
+   if ((nl->type != CT_NEWLINE) || (nl->level != 0) ||
+       ((nl->flags & (PCF_IN_PREPROC | PCF_INSERTED)) != 0) ||
+       (nl->pp_level > pp_max) ||
+       ((int)(nl->orig_line + nl->nl_count - 1) < first_line))
+   {
+      return(false);
+   }
+
+   chunk_t *prev = chunk_get_prev_ncnl(nl);
+   if ((prev != NULL) && ((prev->flags & PCF_IN_PREPROC) == 0))
+   {
+      if (prev->level != 0)
+      {
+         return(false);
+      }
+      if (prev->type == CT_BRACE_CLOSE)
+      {
+         /* 'struct a { } b;' goes on after the brace */
+         if ((prev->parent_type == CT_STRUCT) ||
+             (prev->parent_type == CT_UNION) ||
+             (prev->parent_type == CT_ENUM))
+         {
+            return(false);
+         }
+      }
+      else if (!chunk_is_semicolon(prev))
+      {
+         return(false);
+      }
+   }
+
+   chunk_t *next = chunk_get_next_ncnl(nl);
+   if ((next != NULL) && ((next->flags & PCF_IN_PREPROC) == 0) &&
+       (((next->flags & PCF_STMT_START) == 0) || chunk_is_semicolon(next)))
+   {
+      return(false);
+   }
+   return(true);
+}
+
+
+/**
+ * Gets the last input line of a chunk
+ */
+static int lines_last_line(chunk_t *pc)
+{
+   if (chunk_is_newline(pc))
+   {
+      return(pc->orig_line + pc->nl_count - 1);
+   }
+
+   int line = pc->orig_line;
+   for (int idx = 0; idx < pc->str.size(); idx++)
+   {
+      if (pc->str[idx] == '\n')
+      {
+         line++;
+      }
+   }
+   return(line);
+}
+
+
+/**
+ * Checks whether the input lines first to last overlap a '--lines' range
+ */
+static bool lines_requested(int first, int last)
+{
+   for (int idx = 0; idx < (int)cpd.lines.size(); idx++)
+   {
+      if ((cpd.lines[idx].first <= last) && (cpd.lines[idx].last >= first))
+      {
+         return(true);
+      }
+   }
+   return(false);
+}
+
+
+/**
+ * Keeps the regions that hold the '--lines' ranges and their neighbours and
+ * deletes the rest of the chunks, so that the formatting passes only run on
+ * those. The chunks in the regions are marked with PCF_IN_LINES and the ones
+ * next to them with PCF_LINES_CTX. Both are copied to the chunks that are
+ * added later. The input lines of each region are stored in cpd.line_regions
+ * for output_text().
+ *
+ * Removing extra newlines joins lines across the whole file and the #pragma
+ * regions are tracked from the start, so with those the whole file is one
+ * region.
+ */
+void lines_select(void)
+{
+   vector<lines_unit> units;
+   chunk_t            *pc;
+   chunk_t            *tail = chunk_get_tail();
+
+   cpd.line_regions.clear();
+   if (tail == NULL)
+   {
+      return;
+   }
+   cpd.lines_ifdef = ifdef_over_whole_file();
+
+   /* The code in an include guard may be cut up, unless the guard changes
+    * the indent or gets a comment. The #pragma regions are not tracked. */
+   int pp_max = 0;
+   if (cpd.lines_ifdef &&
+       !cpd.settings[UO_pp_if_indent_code].b &&
+       (cpd.settings[UO_mod_add_long_ifdef_else_comment].n == 0) &&
+       (cpd.settings[UO_mod_add_long_ifdef_endif_comment].n == 0))
+   {
+      pp_max = 1;
+   }
+   bool whole = (cpd.settings[UO_nl_remove_extra_newlines].n == 2) ||
+                cpd.settings[UO_pp_region_indent_code].b;
+
+   /* Split the file into units, which cover all of the input lines */
+   lines_unit unit;
+   int        brace_line = 0;
+   int        last_line  = 1;
+   unit.first      = chunk_get_head();
+   unit.first_line = 1;
+   unit.braces     = false;
+   for (pc = unit.first; pc != NULL; pc = chunk_get_next(pc))
+   {
+      /* The file footer has its own line numbers, but it is short */
+      if ((pc->flags & PCF_INSERTED) == 0)
+      {
+         last_line = max(last_line, lines_last_line(pc));
+      }
+      if (pc->level == 0)
+      {
+         if (pc->type == CT_BRACE_OPEN)
+         {
+            brace_line = pc->orig_line;
+         }
+         else if ((pc->type == CT_BRACE_CLOSE) && ((int)pc->orig_line != brace_line))
+         {
+            unit.braces = true;
+         }
+      }
+      if ((pc == tail) || lines_is_unit_end(pc, pp_max, unit.first_line))
+      {
+         unit.last      = pc;
+         unit.last_line = chunk_is_newline(pc) ? (pc->orig_line + pc->nl_count - 1) : pc->orig_line;
+         unit.gap       = pc->nl_count;
+         if (pc == tail)
+         {
+            /* A range past the end of the file selects nothing */
+            unit.last_line = last_line;
+         }
+         units.push_back(unit);
+
+         unit.first      = chunk_get_next(pc);
+         unit.first_line = unit.last_line + 1;
+         unit.braces     = false;
+      }
+   }
+
+   /* Group the units that may align with each other */
+   int max_span = 0;
+   for (int idx = 0; idx < (int)ARRAY_SIZE(lines_spans); idx++)
+   {
+      max_span = max(max_span, cpd.settings[lines_spans[idx]].n);
+   }
+
+   /* The imports are sorted in runs of lines without a blank line */
+   if (cpd.settings[UO_mod_sort_import].b ||
+       cpd.settings[UO_mod_sort_using].b ||
+       cpd.settings[UO_mod_sort_include].b)
+   {
+      max_span = max(max_span, 1);
+   }
+
+   vector<lines_group> groups;
+   lines_group         grp;
+   grp.first = 0;
+   for (int idx = 0; idx < (int)units.size(); idx++)
+   {
+      if ((idx + 1 < (int)units.size()) &&
+          !units[idx].braces && !units[idx + 1].braces &&
+          (units[idx].gap <= max_span))
+      {
+         continue;
+      }
+      grp.last     = idx;
+      grp.selected = whole || lines_requested(units[grp.first].first_line,
+                                     units[grp.last].last_line);
+      grp.keep = grp.selected;
+      groups.push_back(grp);
+      grp.first = idx + 1;
+   }
+
+   for (int idx = 0; idx < (int)groups.size(); idx++)
+   {
+      if (groups[idx].selected)
+      {
+         if (idx > 0)
+         {
+            groups[idx - 1].keep = true;
+         }
+         if (idx + 1 < (int)groups.size())
+         {
+            groups[idx + 1].keep = true;
+         }
+      }
+   }
+
+   /* Mark the regions and drop the chunks that are not needed */
+   for (int idx = 0; idx < (int)groups.size(); idx++)
+   {
+      const lines_group& g     = groups[idx];
+      chunk_t            *end  = chunk_get_next(units[g.last].last);
+      chunk_t            *next = NULL;
+
+      if (g.selected)
+      {
+         line_range lr;
+         lr.first = units[g.first].first_line;
+         lr.last  = min(units[g.last].last_line, last_line);
+         if ((idx > 0) && groups[idx - 1].selected)
+         {
+            cpd.line_regions.back().last = lr.last;
+         }
+         else
+         {
+            cpd.line_regions.push_back(lr);
+         }
+      }
+
+      for (pc = units[g.first].first; pc != end; pc = next)
+      {
+         next = chunk_get_next(pc);
+         if (g.selected)
+         {
+            pc->flags |= PCF_IN_LINES;
+         }
+         else if (g.keep)
+         {
+            pc->flags |= PCF_LINES_CTX;
+         }
+         else
+         {
+            chunk_del(pc);
+         }
+      }
+   }
+}
@@ -19,20 +19,30 @@
 /** Private log structure */
 struct log_buf
 {
-   log_buf() : log_file(0), sev(0), in_log(0), buf_len(0), show_hdr(false)
+   log_buf() : log_file(0), show_hdr(false)
    {
    }
 
    FILE       *log_file;
-   log_sev_t  sev;
-   int        in_log;
-   char       buf[256];
-   int        buf_len;
    log_mask_t mask;
    bool       show_hdr;
 };
 static struct log_buf g_log;
 
+/**
+ * The line being assembled.
+ * Each thread builds its own lines, which are then written with a single
+ * fwrite() so that lines from different threads don't get mixed up.
+ */
+struct log_line
+{
+   log_sev_t sev;
+   int       in_log;
+   char      buf[256];
+   int       buf_len;
+};
+static thread_local struct log_line g_line;
+
 
 /**
  * Initializes the log subsystem - call this first.
@@ -116,19 +126,19 @@ void log_get_mask(log_mask_t& mask)
  */
 static void log_flush(bool force_nl)
 {
-   if (g_log.buf_len > 0)
+   if (g_line.buf_len > 0)
    {
-      if (force_nl && (g_log.buf[g_log.buf_len - 1] != '\n'))
+      if (force_nl && (g_line.buf[g_line.buf_len - 1] != '\n'))
       {
-         g_log.buf[g_log.buf_len++] = '\n';
-         g_log.buf[g_log.buf_len]   = 0;
+         g_line.buf[g_line.buf_len++] = '\n';
+         g_line.buf[g_line.buf_len]   = 0;
       }
-      if (fwrite(g_log.buf, g_log.buf_len, 1,g_log .log_file) != 1)
+      if (fwrite(g_line.buf, g_line.buf_len, 1, g_log.log_file) != 1)
       {
          /* maybe we should log something to complain... =) */
       }
 
-      g_log.buf_len = 0;
+      g_line.buf_len = 0;
    }
 }
 
@@ -141,23 +151,23 @@ static void log_flush(bool force_nl)
  */
 static size_t log_start(log_sev_t sev)
 {
-   if (sev != g_log.sev)
+   if (sev != g_line.sev)
    {
-      if (g_log.buf_len > 0)
+      if (g_line.buf_len > 0)
       {
          log_flush(true);
       }
-      g_log.sev    = sev;
-      g_log.in_log = false;
+      g_line.sev    = sev;
+      g_line.in_log = false;
    }
 
    /* If not in a log, the buffer is empty. Add the header, if enabled. */
-   if (!g_log.in_log && g_log.show_hdr)
+   if (!g_line.in_log && g_log.show_hdr)
    {
-      g_log.buf_len = snprintf(g_log.buf, sizeof(g_log.buf), "<%d>", sev);
+      g_line.buf_len = snprintf(g_line.buf, sizeof(g_line.buf), "<%d>", sev);
    }
 
-   int cap = ((int)sizeof(g_log.buf) - 2) - g_log.buf_len;
+   int cap = ((int)sizeof(g_line.buf) - 2) - g_line.buf_len;
 
    return((cap > 0) ? (size_t)cap : 0);
 }
@@ -169,8 +179,8 @@ static size_t log_start(log_sev_t sev)
  */
 static void log_end(void)
 {
-   g_log.in_log = (g_log.buf[g_log.buf_len - 1] != '\n');
-   if (!g_log.in_log || (g_log.buf_len > (int)(sizeof(g_log.buf) / 2)))
+   g_line.in_log = (g_line.buf[g_line.buf_len - 1] != '\n');
+   if (!g_line.in_log || (g_line.buf_len > (int)(sizeof(g_line.buf) / 2)))
    {
       log_flush(false);
    }
@@ -198,9 +208,9 @@ void log_str(log_sev_t sev, const char *str, int len)
       {
          len = cap;
       }
-      memcpy(&g_log.buf[g_log.buf_len], str, len);
-      g_log.buf_len           += len;
-      g_log.buf[g_log.buf_len] = 0;
+      memcpy(&g_line.buf[g_line.buf_len], str, len);
+      g_line.buf_len            += len;
+      g_line.buf[g_line.buf_len] = 0;
    }
    log_end();
 }
@@ -232,7 +242,7 @@ void log_fmt(log_sev_t sev, const char *fmt, ...)
 
    /* Add on the variable log parameters to the log string */
    va_start(args, fmt);
-   len = vsnprintf(&g_log.buf[g_log.buf_len], cap, fmt, args);
+   len = vsnprintf(&g_line.buf[g_line.buf_len], cap, fmt, args);
    va_end(args);
 
    if (len > 0)
@@ -241,8 +251,8 @@ void log_fmt(log_sev_t sev, const char *fmt, ...)
       {
          len = cap;
       }
-      g_log.buf_len           += len;
-      g_log.buf[g_log.buf_len] = 0;
+      g_line.buf_len            += len;
+      g_line.buf[g_line.buf_len] = 0;
    }
 
    log_end();
@@ -300,7 +310,7 @@ void log_hex(log_sev_t sev, const void *vdata, int len)
  */
 void log_hex_blk(log_sev_t sev, const void *data, int len)
 {
-   static char buf[80] = "nnn | XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX | cccccccccccccccc\n";
+   static thread_local char buf[80] = "nnn | XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX | cccccccccccccccc\n";
    const UINT8 *dat    = (const UINT8 *)data;
    int         idx;
    int         count;
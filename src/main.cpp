@@ -0,0 +1,15 @@
+/**
+ * @file main.cpp
+ * The entry point of the uncrustify command line tool.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "uncrustify_types.h"
+#include "prototypes.h"
+
+
+int main(int argc, char *argv[])
+{
+   return(uncrustify_main(argc, argv));
+}
@@ -482,8 +482,7 @@ static bool newlines_if_for_while_switch(chunk_t *start, argval_t nl_opt)
       brace_open  = chunk_get_next_ncnl(close_paren);
 
       if ((brace_open != NULL) &&
-          ((brace_open->type == CT_BRACE_OPEN) ||
-           (brace_open->type == CT_VBRACE_OPEN)) &&
+          chunk_is_opening_brace(brace_open) &&
           one_liner_nl_ok(brace_open))
       {
          if (cpd.settings[UO_nl_multi_line_cond].b)
@@ -642,7 +641,7 @@ static chunk_t *get_closing_brace(chunk_t *start)
 
    for (pc = start; (pc = chunk_get_next(pc)) != NULL; )
    {
-      if (((pc->type == CT_BRACE_CLOSE) || (pc->type == CT_VBRACE_CLOSE)) && (pc->level == level))
+      if (chunk_is_closing_brace(pc) && (pc->level == level))
       {
          return(pc);
       }
@@ -946,8 +945,7 @@ static void newlines_do_else(chunk_t *start, argval_t nl_opt)
 
    next = chunk_get_next_ncnl(start);
    if ((next != NULL) &&
-       ((next->type == CT_BRACE_OPEN) ||
-        (next->type == CT_VBRACE_OPEN)))
+       chunk_is_opening_brace(next))
    {
       if (!one_liner_nl_ok(next))
       {
@@ -1685,9 +1683,7 @@ static bool one_liner_nl_ok(chunk_t *pc)
    chunk_t *br_open = pc;
    if (chunk_is_closing_brace(br_open))
    {
-      br_open = chunk_get_prev_type(br_open,
-                                    br_open->type == CT_BRACE_CLOSE ? CT_BRACE_OPEN : CT_VBRACE_OPEN,
-                                    br_open->level, CNAV_ALL);
+      br_open = chunk_skip_to_match_rev(br_open);
    }
    else
    {
@@ -1701,10 +1697,7 @@ static bool one_liner_nl_ok(chunk_t *pc)
    }
    pc = br_open;
    if (pc && (pc->flags & PCF_ONE_LINER) &&
-       ((pc->type == CT_BRACE_OPEN) ||
-        (pc->type == CT_BRACE_CLOSE) ||
-        (pc->type == CT_VBRACE_OPEN) ||
-        (pc->type == CT_VBRACE_CLOSE)))
+       token_is(pc->type, TKF_BRACE_OPEN | TKF_BRACE_CLOSE))
    {
       if (cpd.settings[UO_nl_class_leave_one_liners].b &&
           (pc->flags & PCF_IN_CLASS))
@@ -2929,8 +2922,7 @@ void do_blank_lines(void)
       {
          /* Don't add blanks after a open brace */
          if ((prev == NULL) ||
-             ((prev->type != CT_BRACE_OPEN) &&
-              (prev->type != CT_VBRACE_OPEN)))
+             !chunk_is_opening_brace(prev))
          {
             blank_line_set(pc, UO_nl_before_block_comment);
          }
@@ -2943,8 +2935,7 @@ void do_blank_lines(void)
       {
          /* Don't add blanks after a open brace or a comment */
          if ((prev == NULL) ||
-             ((prev->type != CT_BRACE_OPEN) &&
-              (prev->type != CT_VBRACE_OPEN) &&
+             (!chunk_is_opening_brace(prev) &&
               (pcmt->type != CT_COMMENT)))
          {
             blank_line_set(pc, UO_nl_before_c_comment);
@@ -2958,8 +2949,7 @@ void do_blank_lines(void)
       {
          /* Don't add blanks after a open brace */
          if ((prev == NULL) ||
-             ((prev->type != CT_BRACE_OPEN) &&
-              (prev->type != CT_VBRACE_OPEN) &&
+             (!chunk_is_opening_brace(prev) &&
               (pcmt->type != CT_COMMENT_CPP)))
          {
             blank_line_set(pc, UO_nl_before_cpp_comment);
@@ -2974,8 +2964,7 @@ void do_blank_lines(void)
       {
          /* Don't add blanks after a open brace */
          if ((prev == NULL) ||
-             ((prev->type != CT_BRACE_OPEN) &&
-              (prev->type != CT_VBRACE_OPEN)))
+             !chunk_is_opening_brace(prev))
          {
             blank_line_set(pc, UO_nl_before_access_spec);
          }
@@ -1680,7 +1680,6 @@ int save_option_file(FILE *pfile, bool withDoc)
    /* Print custom defines */
    print_defines(pfile);
 
-   fclose(pfile);
    return(0);
 }
 
@@ -10,6 +10,7 @@
 #include "chunk_list.h"
 #include "unc_ctype.h"
 #include <cstdlib>
+#include <algorithm>
 
 static void output_comment_multi(chunk_t *pc);
 static void output_comment_multi_simple(chunk_t *pc);
@@ -36,17 +37,50 @@ static void add_comment_text(const unc_text& text,
 #define LOG_CONTTEXT() \
    LOG_FMT(LCONTTEXT, "%s:%d set cont_text to '%s'\n", __func__, __LINE__, cmt.cont_text.c_str())
 
+/**
+ * Compares the pending output with the file in cpd.out_cmp and drops it.
+ * Sets cpd.out_differs at the first byte that doesn't match, which leaves
+ * cpd.out_cmp_pos at the offset of that byte.
+ */
+static void output_compare()
+{
+   vector<UINT8>& out  = *cpd.out;
+   const UINT8    *ref = cpd.out_cmp->bytes();
+   size_t         len  = cpd.out_cmp->size();
+   size_t         idx;
+
+   for (idx = 0; (idx < out.size()) && !cpd.out_differs; idx++)
+   {
+      if ((cpd.out_cmp_pos >= len) || (out[idx] != ref[cpd.out_cmp_pos]))
+      {
+         cpd.out_differs = true;
+      }
+      else
+      {
+         cpd.out_cmp_pos++;
+      }
+   }
+   out.clear();
+}
+
+
 /**
  * All output text is sent here, one char at a time.
  */
 static void add_char(UINT32 ch)
 {
-   static int last_char = 0;
+   /* When comparing, the output is dropped as soon as it is checked.
+    * The column is still tracked, as callers loop on it.
+    */
+   if (cpd.out_cmp != NULL)
+   {
+      output_compare();
+   }
 
    /* If we did a '\r' and it isn't followed by a '\n', then output a newline */
-   if ((last_char == '\r') && (ch != '\n'))
+   if ((cpd.last_char == '\r') && (ch != '\n'))
    {
-      write_string(cpd.fout, cpd.newline.get(), cpd.enc);
+      write_string(*cpd.out, cpd.newline.get(), cpd.enc);
       cpd.column      = 1;
       cpd.did_newline = 1;
       cpd.spaces      = 0;
@@ -55,7 +89,7 @@ static void add_char(UINT32 ch)
    /* convert a newline into the LF/CRLF/CR sequence */
    if (ch == '\n')
    {
-      write_string(cpd.fout, cpd.newline.get(), cpd.enc);
+      write_string(*cpd.out, cpd.newline.get(), cpd.enc);
       cpd.column      = 1;
       cpd.did_newline = 1;
       cpd.spaces      = 0;
@@ -70,7 +104,7 @@ static void add_char(UINT32 ch)
    else
    {
       /* Explicitly disallow a tab after a space */
-      if ((ch == '\t') && (last_char == ' '))
+      if ((ch == '\t') && (cpd.last_char == ' '))
       {
          int endcol = next_tab_column(cpd.column);
          while (cpd.column < endcol)
@@ -86,12 +120,12 @@ static void add_char(UINT32 ch)
       }
       else
       {
-         while (cpd.spaces > 0)
+         if (cpd.spaces > 0)
          {
-            write_char(cpd.fout, ' ', cpd.enc);
-            cpd.spaces--;
+            write_chars(*cpd.out, ' ', cpd.spaces, cpd.enc);
+            cpd.spaces = 0;
          }
-         write_char(cpd.fout, ch, cpd.enc);
+         write_char(*cpd.out, ch, cpd.enc);
          if (ch == '\t')
          {
             cpd.column = next_tab_column(cpd.column);
@@ -102,7 +136,7 @@ static void add_char(UINT32 ch)
          }
       }
    }
-   last_char = ch;
+   cpd.last_char = ch;
 }
 
 
@@ -291,24 +325,66 @@ void output_options(FILE *pfile)
 
 
 /**
- * This renders the chunk list to a file.
+ * Replaces the output from start on with the '--lines' regions.
+ * Each region is the output between two cuts and gets a line with the input
+ * lines it replaces first. Any extra pieces are added to the last region.
  */
-void output_text(FILE *pfile)
+static void output_regions(vector<UINT8>& out, size_t start,
+                           const vector<size_t>& cuts)
 {
-   chunk_t *pc;
-   chunk_t *prev;
-   int     cnt;
-   int     lvlcol;
-   bool    allow_tabs;
+   vector<UINT8> text;
+   size_t        regions = cpd.line_regions.size();
+   char          buf[64];
+
+   for (size_t idx = 0; (idx + 1 < cuts.size()) && (regions > 0); idx += 2)
+   {
+      if (idx / 2 < regions)
+      {
+         const line_range& lr = cpd.line_regions[idx / 2];
+         snprintf(buf, sizeof(buf), "@@ %d-%d @@", lr.first, lr.last);
+         write_string(text, buf, cpd.enc);
+         write_string(text, cpd.newline.get(), cpd.enc);
+      }
+      text.insert(text.end(), out.begin() + cuts[idx], out.begin() + cuts[idx + 1]);
+   }
+   out.resize(start);
+   out.insert(out.end(), text.begin(), text.end());
+}
 
-   cpd.fout = pfile;
+
+/**
+ * This renders the chunk list to a buffer.
+ *
+ * If cpd.out_cmp is set, the output is compared with that text as it is
+ * produced instead of being kept, and rendering stops at the first difference.
+ * The result is left in cpd.out_differs and cpd.out_cmp_pos.
+ *
+ * If cpd.lines is set, only the regions picked by lines_select() are kept,
+ * each after a '@@ FIRST-LAST @@' line with the input lines it replaces.
+ */
+void output_text(vector<UINT8>& out)
+{
+   chunk_t        *pc;
+   chunk_t        *prev;
+   int            cnt;
+   int            lvlcol;
+   bool           allow_tabs;
+   bool           in_lines = false;
+   vector<size_t> cuts;
+
+   cpd.out         = &out;
+   cpd.out_cmp_pos = 0;
+   cpd.out_differs = false;
 
    cpd.did_newline = 1;
    cpd.column      = 1;
+   cpd.last_char   = 0;
+
+   size_t start = out.size();
 
-   if (cpd.bom)
+   if (cpd.bom && cpd.lines.empty())
    {
-      write_bom(pfile, cpd.enc);
+      write_bom(out, cpd.enc);
    }
 
    if (cpd.frag_cols > 0)
@@ -325,6 +401,22 @@ void output_text(FILE *pfile)
 
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
+      if (cpd.out_differs)
+      {
+         break;
+      }
+
+      /* Note where each region starts and ends, the chunks that were added
+       * without either flag go with the ones before them */
+      if ((pc->flags & (PCF_IN_LINES | PCF_LINES_CTX)) != 0)
+      {
+         if (((pc->flags & PCF_IN_LINES) != 0) != in_lines)
+         {
+            in_lines = !in_lines;
+            cuts.push_back(out.size());
+         }
+      }
+
       if (pc->type == CT_NEWLINE)
       {
          for (cnt = 0; cnt < pc->nl_count; cnt++)
@@ -466,6 +558,25 @@ void output_text(FILE *pfile)
          cpd.did_newline = chunk_is_newline(pc);
       }
    }
+
+   if (!cpd.lines.empty())
+   {
+      if (in_lines)
+      {
+         cuts.push_back(out.size());
+      }
+      output_regions(out, start, cuts);
+   }
+
+   if (cpd.out_cmp != NULL)
+   {
+      output_compare();
+      /* Stopping short of the end counts as a difference, too */
+      if (cpd.out_cmp_pos < cpd.out_cmp->size())
+      {
+         cpd.out_differs = true;
+      }
+   }
 }
 
 /**
@@ -97,6 +97,7 @@ static void add_parens_between(chunk_t *first, chunk_t *last)
       tmp->level++;
    }
    last_p->level++;
+   chunk_match_changed();
 }
 
 
@@ -11,6 +11,7 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
 
 /**
  * Logs one parse frame
@@ -70,10 +71,25 @@ void pf_log_all(int logsev)
 
 /**
  * Copies src to dst.
+ * The paren stack of dst keeps its memory, so this doesn't allocate once
+ * the frames have been used.
  */
 void pf_copy(struct parse_frame *dst, const struct parse_frame *src)
 {
-   memcpy(dst, src, sizeof(struct parse_frame));
+   *dst = *src;
+}
+
+
+/**
+ * Makes sure that there is a frame at cpd.frame_count.
+ * The frames past cpd.frame_count are kept for their memory.
+ */
+static void pf_make_room(void)
+{
+   if (cpd.frame_count >= (int)cpd.frames.size())
+   {
+      cpd.frames.resize(cpd.frame_count + 1);
+   }
 }
 
 
@@ -83,37 +99,30 @@ void pf_copy(struct parse_frame *dst, const struct parse_frame *src)
  */
 void pf_push(struct parse_frame *pf)
 {
-   static int ref_no = 1;
+   static thread_local int ref_no = 1;
 
-   if (cpd.frame_count < (int)ARRAY_SIZE(cpd.frames))
-   {
-      pf_copy(&cpd.frames[cpd.frame_count], pf);
-      cpd.frame_count++;
-      pf->ref_no = ref_no++;
-   }
+   pf_make_room();
+   pf_copy(&cpd.frames[cpd.frame_count], pf);
+   cpd.frame_count++;
+   pf->ref_no = ref_no++;
    LOG_FMT(LPF, "%s: count = %d\n", __func__, cpd.frame_count);
 }
 
 
 /**
  * Push a copy of the parse frame onto the stack, under the tos.
- * If this were a linked list, just add before the last item.
+ * The tos is moved up rather than copied.
  * This is called on the first #else and #elif.
  */
 void pf_push_under(struct parse_frame *pf)
 {
-   struct parse_frame *npf1;
-   struct parse_frame *npf2;
-
    LOG_FMT(LPF, "%s: before count = %d\n", __func__, cpd.frame_count);
 
-   if ((cpd.frame_count < (int)ARRAY_SIZE(cpd.frames)) &&
-       (cpd.frame_count >= 1))
+   if (cpd.frame_count >= 1)
    {
-      npf1 = &cpd.frames[cpd.frame_count - 1];
-      npf2 = &cpd.frames[cpd.frame_count];
-      pf_copy(npf2, npf1);
-      pf_copy(npf1, pf);
+      pf_make_room();
+      swap(cpd.frames[cpd.frame_count], cpd.frames[cpd.frame_count - 1]);
+      pf_copy(&cpd.frames[cpd.frame_count - 1], pf);
       cpd.frame_count++;
    }
 
@@ -165,14 +174,15 @@ void pf_trash_tos(void)
 
 
 /**
- * Pop the top item off the stack and copy into pf.
+ * Pop the top item off the stack into pf.
+ * The top item is swapped with pf rather than copied, as it is thrown out.
  * This is called on #endif
  */
 void pf_pop(struct parse_frame *pf)
 {
    if (cpd.frame_count > 0)
    {
-      pf_copy_tos(pf);
+      swap(*pf, cpd.frames[cpd.frame_count - 1]);
       pf_trash_tos();
    }
    //fprintf(stderr, "%s: count = %d\n", __func__, cpd.frame_count);
@@ -24,6 +24,16 @@ void log_pcf_flags(log_sev_t sev, UINT64 flags);
 const char *path_basename(const char *path);
 int path_dirname_len(const char *filename);
 const char *get_file_extension(int& idx);
+int language_from_tag(const char *tag);
+int language_from_extension(const char *filename);
+int language_from_filename(const char *filename);
+const char *language_to_string(int lang);
+int load_mem_file(const char *filename, file_mem& fm);
+int load_header_files();
+void make_folders(const string& filename);
+void uncrustify_file(const file_mem& fm, FILE *pfout, const char *parsed_file);
+void uncrustify_file(const file_mem& fm, vector<UINT8> *out, const char *parsed_file);
+int uncrustify_main(int argc, char *argv[]);
 
 
 /*
@@ -37,12 +47,19 @@ void detect_options();
  *  output.cpp
  */
 
-void output_text(FILE *pfile);
+void output_text(vector<UINT8>& out);
 void output_parsed(FILE *pfile);
 void output_options(FILE *pfile);
 void add_long_preprocessor_conditional_block_comment(void);
 
 
+/*
+ *  lines.cpp
+ */
+
+void lines_select(void);
+
+
 /*
  *  options.cpp
  */
@@ -71,6 +88,7 @@ string op_val_to_string(argtype_e argtype, op_val_t op_val);
 
 void indent_text(void);
 void indent_preproc(void);
+bool ifdef_over_whole_file(void);
 void indent_to_column(chunk_t *pc, int column);
 void align_to_column(chunk_t *pc, int column);
 
@@ -191,7 +209,7 @@ chunk_t *newline_add_between2(chunk_t *start, chunk_t *end,
  *  tokenize.cpp
  */
 
-void tokenize(const deque<int>& data, chunk_t *ref);
+void tokenize(const file_mem& fm, chunk_t *ref);
 
 
 /*
@@ -214,10 +232,14 @@ void brace_cleanup(void);
 
 int load_keyword_file(const char *filename);
 c_token_t find_keyword_type(const char *word, int len);
+c_token_t find_keyword_type(unc_text& word);
+void clear_keyword_cache(void);
 void add_keyword(const char *tag, c_token_t type);
 void output_types(FILE *pfile);
 void print_keywords(FILE *pfile);
 void clear_keyword_file(void);
+dkw_table *keyword_table_new(void);
+void keyword_table_delete(dkw_table *tbl);
 pattern_class get_token_pattern_class(c_token_t tok);
 bool keywords_are_sorted(void);
 
@@ -231,11 +253,14 @@ void add_define(const char *tag, const char *value);
 void output_defines(FILE *pfile);
 void print_defines(FILE *pfile);
 void clear_defines(void);
+define_table *define_table_new(void);
+void define_table_delete(define_table *tbl);
 
 
 /*
  *  punctuators.cpp
  */
+const chunk_tag_t *find_punctuator(const UINT8 *str, int len, int lang_flags);
 const chunk_tag_t *find_punctuator(const char *str, int lang_flags);
 
 
@@ -277,11 +302,13 @@ void print_universal_indent_cfg(FILE *pfile);
 /*
  * unicode.cpp
  */
-void write_bom(FILE *pf, CharEncoding enc);
-void write_char(FILE *pf, int ch, CharEncoding enc);
-void write_string(FILE *pf, const deque<int>& text, CharEncoding enc);
-void write_string(FILE *pf, const char *ascii_text, CharEncoding enc);
-bool decode_unicode(const vector<UINT8>& in_data, deque<int>& out_data, CharEncoding& enc, bool& has_bom);
+void write_bom(vector<UINT8>& out, CharEncoding enc);
+void write_char(vector<UINT8>& out, int ch, CharEncoding enc);
+void write_chars(vector<UINT8>& out, int ch, int count, CharEncoding enc);
+void write_string(vector<UINT8>& out, const vector<int>& text, CharEncoding enc);
+void write_string(vector<UINT8>& out, const char *ascii_text, CharEncoding enc);
+bool decode_unicode(const UINT8 *in_data, size_t in_len, vector<int>& out_data, CharEncoding& enc, bool& has_bom);
+bool decode_file(file_mem& fm);
 void encode_utf8(int ch, vector<UINT8>& res);
 
 
@@ -11,7 +11,7 @@
 
 /**
  *
- *   The file "punctuators.h" was generated by punc.py from this file.
+ *   The matcher in "punctuators.h" was generated by punc.py from this file.
  *   If you change one of the below symbol tables, re-run punc.py.
  *   $ python scripts/punc.py > src/punctuators.h
  *
@@ -112,44 +112,16 @@ static const chunk_tag_t symbols1[] =
 
 #include "punctuators.h"
 
-const chunk_tag_t *find_punctuator(const char *str, int lang_flags)
+const chunk_tag_t *find_punctuator(const UINT8 *str, int len, int lang_flags)
 {
-   const chunk_tag_t    *p_match = NULL;
-   const lookup_entry_t *p_tab   = punc_table;
-
-   int ch_idx = 0;
+   return(punc_match(str, len, lang_flags));
+}
 
-   /*REVISIT: it might be faster to do a bsearch() on the first char.
-    *         the rest of the group have at most 5 entries, so it wouldn't help
-    */
 
-   while (ch_idx < 4)
-   {
-      if (p_tab->ch == str[ch_idx])
-      {
-         /* Match */
-         if ((p_tab->tag != NULL) &&
-             ((p_tab->tag->lang_flags & lang_flags) != 0))
-         {
-            p_match = p_tab->tag;
-         }
-         if (p_tab->next_idx == 0)
-         {
-            /* This is the end of the chain */
-            break;
-         }
-         p_tab = &punc_table[p_tab->next_idx];
-         ch_idx++;
-      }
-      else if (p_tab->left_in_group == 0)
-      {
-         /* The last entry in this group didn't match */
-         break;
-      }
-      else
-      {
-         p_tab++;
-      }
-   }
-   return(p_match);
+/**
+ * Same as above for a zero terminated string, which ends the match
+ */
+const chunk_tag_t *find_punctuator(const char *str, int lang_flags)
+{
+   return(punc_match((const UINT8 *)str, 4, lang_flags));
 }
@@ -1,79 +1,674 @@
 /**
  * @file punctuators.h
- * Automatically generated
+ * Automatically generated by scripts/punc.py
  */
-static const lookup_entry_t punc_table[] =
+
+/**
+ * Finds the longest punctuator at str that is used by the language.
+ * There is a nested switch for each char of the punctuators.
+ *
+ * @param str   The text, which need not be terminated
+ * @param len   The number of chars that can be read at str
+ */
+static const chunk_tag_t *punc_match(const UINT8 *str, int len, int lang_flags)
 {
-   { '!', 25, 26, &symbols1[0]  },   //   0: '!'
-   { '#', 24, 35, &symbols1[1]  },   //   1: '#'
-   { '$', 23,  0, &symbols1[2]  },   //   2: '$'
-   { '%', 22, 37, &symbols1[3]  },   //   3: '%'
-   { '&', 21, 38, &symbols1[4]  },   //   4: '&'
-   { '(', 20,  0, &symbols1[5]  },   //   5: '('
-   { ')', 19,  0, &symbols1[6]  },   //   6: ')'
-   { '*', 18, 40, &symbols1[7]  },   //   7: '*'
-   { '+', 17, 41, &symbols1[8]  },   //   8: '+'
-   { ',', 16,  0, &symbols1[9]  },   //   9: ','
-   { '-', 15, 43, &symbols1[10] },   //  10: '-'
-   { '.', 14, 47, &symbols1[11] },   //  11: '.'
-   { '/', 13, 50, &symbols1[12] },   //  12: '/'
-   { ':', 12, 51, &symbols1[13] },   //  13: ':'
-   { ';', 11,  0, &symbols1[14] },   //  14: ';'
-   { '<', 10, 52, &symbols1[15] },   //  15: '<'
-   { '=',  9, 57, &symbols1[16] },   //  16: '='
-   { '>',  8, 60, &symbols1[17] },   //  17: '>'
-   { '?',  7, 65, &symbols1[18] },   //  18: '?'
-   { '[',  6, 66, &symbols1[19] },   //  19: '['
-   { ']',  5,  0, &symbols1[20] },   //  20: ']'
-   { '^',  4, 67, &symbols1[21] },   //  21: '^'
-   { '{',  3,  0, &symbols1[22] },   //  22: '{'
-   { '|',  2, 68, &symbols1[23] },   //  23: '|'
-   { '}',  1,  0, &symbols1[24] },   //  24: '}'
-   { '~',  0, 70, &symbols1[25] },   //  25: '~'
-   { '<',  3, 30, &symbols2[0]  },   //  26: '!<'
-   { '=',  2, 33, &symbols2[1]  },   //  27: '!='
-   { '>',  1, 34, &symbols2[2]  },   //  28: '!>'
-   { '~',  0,  0, &symbols2[3]  },   //  29: '!~'
-   { '=',  1,  0, &symbols3[0]  },   //  30: '!<='
-   { '>',  0, 32, &symbols3[1]  },   //  31: '!<>'
-   { '=',  0,  0, &symbols4[0]  },   //  32: '!<>='
-   { '=',  0,  0, &symbols3[2]  },   //  33: '!=='
-   { '=',  0,  0, &symbols3[3]  },   //  34: '!>='
-   { '#',  1,  0, &symbols2[4]  },   //  35: '##'
-   { '@',  0,  0, &symbols2[5]  },   //  36: '#@'
-   { '=',  0,  0, &symbols2[6]  },   //  37: '%='
-   { '&',  1,  0, &symbols2[7]  },   //  38: '&&'
-   { '=',  0,  0, &symbols2[8]  },   //  39: '&='
-   { '=',  0,  0, &symbols2[9]  },   //  40: '*='
-   { '+',  1,  0, &symbols2[10] },   //  41: '++'
-   { '=',  0,  0, &symbols2[11] },   //  42: '+='
-   { '-',  2,  0, &symbols2[12] },   //  43: '--'
-   { '=',  1,  0, &symbols2[13] },   //  44: '-='
-   { '>',  0, 46, &symbols2[14] },   //  45: '->'
-   { '*',  0,  0, &symbols3[4]  },   //  46: '->*'
-   { '*',  1,  0, &symbols2[15] },   //  47: '.*'
-   { '.',  0, 49, &symbols2[16] },   //  48: '..'
-   { '.',  0,  0, &symbols3[5]  },   //  49: '...'
-   { '=',  0,  0, &symbols2[17] },   //  50: '/='
-   { ':',  0,  0, &symbols2[18] },   //  51: '::'
-   { '<',  2, 55, &symbols2[19] },   //  52: '<<'
-   { '=',  1,  0, &symbols2[20] },   //  53: '<='
-   { '>',  0, 56, &symbols2[21] },   //  54: '<>'
-   { '=',  0,  0, &symbols3[6]  },   //  55: '<<='
-   { '=',  0,  0, &symbols3[7]  },   //  56: '<>='
-   { '=',  1, 59, &symbols2[22] },   //  57: '=='
-   { '>',  0,  0, &symbols2[31] },   //  58: '=>'
-   { '=',  0,  0, &symbols3[8]  },   //  59: '==='
-   { '=',  1,  0, &symbols2[23] },   //  60: '>='
-   { '>',  0, 62, &symbols2[24] },   //  61: '>>'
-   { '=',  1,  0, &symbols3[9]  },   //  62: '>>='
-   { '>',  0, 64, &symbols3[10] },   //  63: '>>>'
-   { '=',  0,  0, &symbols4[1]  },   //  64: '>>>='
-   { '?',  0,  0, &symbols2[32] },   //  65: '??'
-   { ']',  0,  0, &symbols2[25] },   //  66: '[]'
-   { '=',  0,  0, &symbols2[26] },   //  67: '^='
-   { '=',  1,  0, &symbols2[27] },   //  68: '|='
-   { '|',  0,  0, &symbols2[28] },   //  69: '||'
-   { '=',  1,  0, &symbols2[29] },   //  70: '~='
-   { '~',  0,  0, &symbols2[30] },   //  71: '~~'
-};
+   const chunk_tag_t *p_match = NULL;
+
+   if (len <= 0)
+   {
+      return(NULL);
+   }
+
+   switch (str[0])
+   {
+   case '!':
+      if ((symbols1[0].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[0];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '<':
+            if ((symbols2[0].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[0];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[0].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[0];
+                  }
+                  break;
+
+               case '>':
+                  if ((symbols3[1].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[1];
+                  }
+                  if (len > 3)
+                  {
+                     switch (str[3])
+                     {
+                     case '=':
+                        if ((symbols4[0].lang_flags & lang_flags) != 0)
+                        {
+                           p_match = &symbols4[0];
+                        }
+                        break;
+                     }
+                  }
+                  break;
+               }
+            }
+            break;
+
+         case '=':
+            if ((symbols2[1].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[1];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[2].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[2];
+                  }
+                  break;
+               }
+            }
+            break;
+
+         case '>':
+            if ((symbols2[2].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[2];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[3].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[3];
+                  }
+                  break;
+               }
+            }
+            break;
+
+         case '~':
+            if ((symbols2[3].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[3];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '#':
+      if ((symbols1[1].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[1];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '#':
+            if ((symbols2[4].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[4];
+            }
+            break;
+
+         case '@':
+            if ((symbols2[5].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[5];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '$':
+      if ((symbols1[2].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[2];
+      }
+      break;
+
+   case '%':
+      if ((symbols1[3].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[3];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[6].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[6];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '&':
+      if ((symbols1[4].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[4];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '&':
+            if ((symbols2[7].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[7];
+            }
+            break;
+
+         case '=':
+            if ((symbols2[8].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[8];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '(':
+      if ((symbols1[5].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[5];
+      }
+      break;
+
+   case ')':
+      if ((symbols1[6].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[6];
+      }
+      break;
+
+   case '*':
+      if ((symbols1[7].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[7];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[9].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[9];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '+':
+      if ((symbols1[8].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[8];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '+':
+            if ((symbols2[10].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[10];
+            }
+            break;
+
+         case '=':
+            if ((symbols2[11].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[11];
+            }
+            break;
+         }
+      }
+      break;
+
+   case ',':
+      if ((symbols1[9].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[9];
+      }
+      break;
+
+   case '-':
+      if ((symbols1[10].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[10];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '-':
+            if ((symbols2[12].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[12];
+            }
+            break;
+
+         case '=':
+            if ((symbols2[13].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[13];
+            }
+            break;
+
+         case '>':
+            if ((symbols2[14].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[14];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '*':
+                  if ((symbols3[4].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[4];
+                  }
+                  break;
+               }
+            }
+            break;
+         }
+      }
+      break;
+
+   case '.':
+      if ((symbols1[11].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[11];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '*':
+            if ((symbols2[15].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[15];
+            }
+            break;
+
+         case '.':
+            if ((symbols2[16].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[16];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '.':
+                  if ((symbols3[5].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[5];
+                  }
+                  break;
+               }
+            }
+            break;
+         }
+      }
+      break;
+
+   case '/':
+      if ((symbols1[12].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[12];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[17].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[17];
+            }
+            break;
+         }
+      }
+      break;
+
+   case ':':
+      if ((symbols1[13].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[13];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case ':':
+            if ((symbols2[18].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[18];
+            }
+            break;
+         }
+      }
+      break;
+
+   case ';':
+      if ((symbols1[14].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[14];
+      }
+      break;
+
+   case '<':
+      if ((symbols1[15].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[15];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '<':
+            if ((symbols2[19].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[19];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[6].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[6];
+                  }
+                  break;
+               }
+            }
+            break;
+
+         case '=':
+            if ((symbols2[20].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[20];
+            }
+            break;
+
+         case '>':
+            if ((symbols2[21].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[21];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[7].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[7];
+                  }
+                  break;
+               }
+            }
+            break;
+         }
+      }
+      break;
+
+   case '=':
+      if ((symbols1[16].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[16];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[22].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[22];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[8].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[8];
+                  }
+                  break;
+               }
+            }
+            break;
+
+         case '>':
+            if ((symbols2[31].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[31];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '>':
+      if ((symbols1[17].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[17];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[23].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[23];
+            }
+            break;
+
+         case '>':
+            if ((symbols2[24].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[24];
+            }
+            if (len > 2)
+            {
+               switch (str[2])
+               {
+               case '=':
+                  if ((symbols3[9].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[9];
+                  }
+                  break;
+
+               case '>':
+                  if ((symbols3[10].lang_flags & lang_flags) != 0)
+                  {
+                     p_match = &symbols3[10];
+                  }
+                  if (len > 3)
+                  {
+                     switch (str[3])
+                     {
+                     case '=':
+                        if ((symbols4[1].lang_flags & lang_flags) != 0)
+                        {
+                           p_match = &symbols4[1];
+                        }
+                        break;
+                     }
+                  }
+                  break;
+               }
+            }
+            break;
+         }
+      }
+      break;
+
+   case '?':
+      if ((symbols1[18].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[18];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '?':
+            if ((symbols2[32].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[32];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '[':
+      if ((symbols1[19].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[19];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case ']':
+            if ((symbols2[25].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[25];
+            }
+            break;
+         }
+      }
+      break;
+
+   case ']':
+      if ((symbols1[20].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[20];
+      }
+      break;
+
+   case '^':
+      if ((symbols1[21].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[21];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[26].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[26];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '{':
+      if ((symbols1[22].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[22];
+      }
+      break;
+
+   case '|':
+      if ((symbols1[23].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[23];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[27].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[27];
+            }
+            break;
+
+         case '|':
+            if ((symbols2[28].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[28];
+            }
+            break;
+         }
+      }
+      break;
+
+   case '}':
+      if ((symbols1[24].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[24];
+      }
+      break;
+
+   case '~':
+      if ((symbols1[25].lang_flags & lang_flags) != 0)
+      {
+         p_match = &symbols1[25];
+      }
+      if (len > 1)
+      {
+         switch (str[1])
+         {
+         case '=':
+            if ((symbols2[29].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[29];
+            }
+            break;
+
+         case '~':
+            if ((symbols2[30].lang_flags & lang_flags) != 0)
+            {
+               p_match = &symbols2[30];
+            }
+            break;
+         }
+      }
+      break;
+   }
+   return(p_match);
+}
@@ -0,0 +1,391 @@
+/**
+ * @file recurse.cpp
+ * Finds the source files in folder trees, for '--recursive'.
+ * See recurse.h for the details.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "prototypes.h"
+#include "recurse.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+
+enum entry_type
+{
+   ET_FILE,
+   ET_FOLDER,
+   ET_LINK,     /* not known yet, may be a link to a file */
+};
+
+struct folder_entry
+{
+   string     name;
+   entry_type type;
+};
+
+
+static bool folder_entry_less(const folder_entry& a, const folder_entry& b)
+{
+   return(a.name < b.name);
+}
+
+
+static bool is_sep(char ch)
+{
+   return((ch == '/') || (ch == '\\'));
+}
+
+
+/**
+ * Matches the text against a glob.
+ * A separator in the glob matches either kind of separator.
+ */
+static bool glob_match(const char *pat, const char *str)
+{
+   while (*pat != 0)
+   {
+      if (*pat == '*')
+      {
+         bool any = (pat[1] == '*');
+
+         pat += any ? 2 : 1;
+
+         /* '**' followed by a separator also matches no folder at all */
+         if (any && is_sep(*pat) && glob_match(pat + 1, str))
+         {
+            return(true);
+         }
+         while (true)
+         {
+            if (glob_match(pat, str))
+            {
+               return(true);
+            }
+            if ((*str == 0) || (!any && is_sep(*str)))
+            {
+               return(false);
+            }
+            str++;
+         }
+      }
+
+      if (*str == 0)
+      {
+         return(false);
+      }
+      if (is_sep(*pat))
+      {
+         if (!is_sep(*str))
+         {
+            return(false);
+         }
+      }
+      else if (*pat == '?')
+      {
+         if (is_sep(*str))
+         {
+            return(false);
+         }
+      }
+      else if (*pat != *str)
+      {
+         return(false);
+      }
+      pat++;
+      str++;
+   }
+   return(*str == 0);
+}
+
+
+/**
+ * Checks the name and relative path of a file or folder against the globs.
+ */
+static bool filter_match(const vector<string>& globs,
+                         const char *name, const char *rel_path)
+{
+   for (size_t idx = 0; idx < globs.size(); idx++)
+   {
+      const char *glob = globs[idx].c_str();
+
+      if (strpbrk(glob, "/\\") == NULL)
+      {
+         if (glob_match(glob, name))
+         {
+            return(true);
+         }
+      }
+      else if (glob_match(is_sep(*glob) ? glob + 1 : glob, rel_path))
+      {
+         return(true);
+      }
+   }
+   return(false);
+}
+
+
+/**
+ * Checks whether a file is taken, without looking at the file.
+ */
+static bool filter_file(const recurse_filter& filter,
+                        const char *name, const char *rel_path)
+{
+   if (filter.include.empty())
+   {
+      if (language_from_extension(name) == 0)
+      {
+         return(false);
+      }
+   }
+   else if (!filter_match(filter.include, name, rel_path))
+   {
+      return(false);
+   }
+   return(!filter_match(filter.exclude, name, rel_path));
+}
+
+
+bool recurse_load_ignore_file(const char *filename, recurse_filter& filter)
+{
+   FILE *pf = fopen(filename, "r");
+
+   if (pf == NULL)
+   {
+      LOG_FMT(LERR, "%s: fopen(%s) failed: %s (%d)\n",
+              __func__, filename, strerror(errno), errno);
+      return(false);
+   }
+
+   char line[1024];
+   while (fgets(line, sizeof(line), pf) != NULL)
+   {
+      /* Trim the line ending, trailing spaces and a trailing '/' */
+      int len = strlen(line);
+      while ((len > 0) && ((line[len - 1] == '\n') || (line[len - 1] == '\r') ||
+                           (line[len - 1] == ' ') || (line[len - 1] == '\t')))
+      {
+         len--;
+      }
+      if ((len > 1) && is_sep(line[len - 1]))
+      {
+         len--;
+      }
+      line[len] = 0;
+
+      if ((len > 0) && (line[0] != '#'))
+      {
+         filter.exclude.push_back(line);
+      }
+   }
+   fclose(pf);
+   return(true);
+}
+
+
+/**
+ * Reads the names in a folder.
+ * The type comes from the folder listing where possible, to save a stat()
+ * per file.
+ *
+ * @return false if the folder can't be read
+ */
+static bool list_folder(const string& path, vector<folder_entry>& entries)
+{
+   folder_entry fe;
+
+#ifdef WIN32
+   WIN32_FIND_DATAA fd;
+   HANDLE           hfind = FindFirstFileA((path + "\\*").c_str(), &fd);
+
+   if (hfind == INVALID_HANDLE_VALUE)
+   {
+      return(false);
+   }
+   do
+   {
+      fe.name = fd.cFileName;
+      if ((fe.name == ".") || (fe.name == ".."))
+      {
+         continue;
+      }
+      if ((fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+      {
+         /* Don't follow junctions and links to folders */
+         if ((fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0)
+         {
+            continue;
+         }
+         fe.type = ET_FOLDER;
+      }
+      else
+      {
+         fe.type = ET_FILE;
+      }
+      entries.push_back(fe);
+   } while (FindNextFileA(hfind, &fd));
+   FindClose(hfind);
+#else
+   DIR *dir = opendir(path.c_str());
+
+   if (dir == NULL)
+   {
+      return(false);
+   }
+
+   struct dirent *de;
+   while ((de = readdir(dir)) != NULL)
+   {
+      fe.name = de->d_name;
+      if ((fe.name == ".") || (fe.name == ".."))
+      {
+         continue;
+      }
+      fe.type = ET_LINK;
+#ifdef DT_UNKNOWN
+      if (de->d_type == DT_DIR)
+      {
+         fe.type = ET_FOLDER;
+      }
+      else if (de->d_type == DT_REG)
+      {
+         fe.type = ET_FILE;
+      }
+      else if ((de->d_type != DT_LNK) && (de->d_type != DT_UNKNOWN))
+      {
+         /* devices, pipes, sockets */
+         continue;
+      }
+#endif
+      entries.push_back(fe);
+   }
+   closedir(dir);
+#endif
+
+   sort(entries.begin(), entries.end(), folder_entry_less);
+   return(true);
+}
+
+
+/**
+ * Finds out what an entry is when the folder listing didn't say.
+ * A link to a file counts as a file, a link to a folder is skipped.
+ *
+ * @return false if the entry is to be skipped
+ */
+static bool resolve_entry(const string& path, folder_entry& fe)
+{
+#ifndef WIN32
+   struct stat my_stat;
+
+   if (lstat(path.c_str(), &my_stat) != 0)
+   {
+      return(false);
+   }
+   if (S_ISDIR(my_stat.st_mode))
+   {
+      fe.type = ET_FOLDER;
+      return(true);
+   }
+   if (S_ISLNK(my_stat.st_mode) && (stat(path.c_str(), &my_stat) != 0))
+   {
+      return(false);
+   }
+   if (S_ISREG(my_stat.st_mode))
+   {
+      fe.type = ET_FILE;
+      return(true);
+   }
+#endif
+   return(false);
+}
+
+
+/**
+ * Walks one folder and the folders below it.
+ *
+ * @param path     The folder
+ * @param rel_len  The length of the part of the path that is walked from
+ */
+static int walk_folder(const string& path, size_t rel_len,
+                       const recurse_filter& filter,
+                       recurse_found_t found, void *arg)
+{
+   vector<folder_entry> entries;
+   int                  errors = 0;
+
+   if (!list_folder(path, entries))
+   {
+      LOG_FMT(LERR, "%s: unable to read %s: %s (%d)\n",
+              __func__, path.c_str(), strerror(errno), errno);
+      return(1);
+   }
+
+   for (size_t idx = 0; idx < entries.size(); idx++)
+   {
+      folder_entry& fe       = entries[idx];
+      string        sub      = path;
+      const char    *name    = fe.name.c_str();
+      const char    *rel_path;
+
+      if (!is_sep(sub[sub.size() - 1]))
+      {
+         sub += PATH_SEP;
+      }
+      sub     += fe.name;
+      rel_path = sub.c_str() + min(rel_len, sub.size());
+
+      /* The name alone tells whether a file or link is to be skipped */
+      if ((fe.type != ET_FOLDER) && !filter_file(filter, name, rel_path))
+      {
+         if (fe.type == ET_FILE)
+         {
+            continue;
+         }
+      }
+      if ((fe.type == ET_LINK) && !resolve_entry(sub, fe))
+      {
+         continue;
+      }
+
+      if (fe.type == ET_FOLDER)
+      {
+         if (!filter_match(filter.exclude, name, rel_path))
+         {
+            errors += walk_folder(sub, rel_len, filter, found, arg);
+         }
+      }
+      else if (filter_file(filter, name, rel_path))
+      {
+         found(sub, arg);
+      }
+   }
+   return(errors);
+}
+
+
+int recurse_folder(const char *folder, const recurse_filter& filter,
+                   recurse_found_t found, void *arg)
+{
+   string path = folder;
+   size_t rel_len;
+
+   /* The relative path starts after the folder and its separator */
+   rel_len = path.size();
+   if ((rel_len > 0) && !is_sep(path[rel_len - 1]))
+   {
+      rel_len++;
+   }
+   return(walk_folder(path, rel_len, filter, found, arg));
+}
@@ -0,0 +1,62 @@
+/**
+ * @file recurse.h
+ * Finds the source files in folder trees, for '--recursive'.
+ *
+ * A file is taken if it matches one of the include globs or, if there are
+ * none, if it has the extension of a known language. Files and folders that
+ * match an exclude glob are skipped, so an excluded folder is never read.
+ * Nothing but the folders is read while walking and a file is only stat'ed
+ * if the folder listing doesn't say what it is.
+ *
+ * Globs support '*' (anything but a path separator), '**' (anything) and '?'.
+ * A glob without a '/' is matched against the name of the file or folder, any
+ * other glob against the path relative to the folder that is walked.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef RECURSE_H_INCLUDED
+#define RECURSE_H_INCLUDED
+
+#include <vector>
+#include <string>
+using namespace std;
+
+
+struct recurse_filter
+{
+   vector<string> include;   /* globs of the files to take */
+   vector<string> exclude;   /* globs of the files and folders to skip */
+};
+
+
+/**
+ * Adds the globs in an ignore file to the exclude list.
+ * The file has one glob per line. Blank lines and lines starting with '#'
+ * are skipped and a trailing '/' is ignored.
+ *
+ * @return false if the file can't be read
+ */
+bool recurse_load_ignore_file(const char *filename, recurse_filter& filter);
+
+
+/**
+ * Called for each file that is found.
+ *
+ * @param path  The path of the file, starting with the folder that is walked
+ * @param arg   The arg passed to recurse_folder()
+ */
+typedef void (*recurse_found_t)(const string& path, void *arg);
+
+
+/**
+ * Walks a folder tree in sorted order and calls found() for each file that
+ * passes the filter. Symbolic links to folders are not followed.
+ *
+ * @return the number of folders that could not be read
+ */
+int recurse_folder(const char *folder, const recurse_filter& filter,
+                   recurse_found_t found, void *arg);
+
+
+#endif /* RECURSE_H_INCLUDED */
@@ -106,7 +106,7 @@ static void check_unknown_brace_close(chunk_t *semi, chunk_t *brace_close)
 {
    chunk_t *pc;
 
-   pc = chunk_get_prev_type(brace_close, CT_BRACE_OPEN, brace_close->level);
+   pc = chunk_skip_to_match_rev(brace_close);
    pc = chunk_get_prev_ncnl(pc);
    if ((pc != NULL) &&
        (pc->type != CT_WORD) &&
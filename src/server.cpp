@@ -0,0 +1,365 @@
+/**
+ * @file server.cpp
+ * Runs uncrustify as a formatting server.
+ * See server.h for the protocol.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "prototypes.h"
+#include "server.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <system_error>
+#include <new>
+#ifndef WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+
+struct server_request
+{
+   char          cmd[16];
+   char          lang[16];
+   vector<UINT8> payload;
+};
+
+
+/* The biggest payload that is accepted, far more than any source file */
+#define SERVER_MAX_PAYLOAD    (64UL * 1024 * 1024)
+
+
+/**
+ * Reads the next request.
+ * If the request can't be read, then error is set to the message for the
+ * ERROR reply, or NULL on EOF.
+ *
+ * @param pin    The stream to read from
+ * @param req    Where to put the request
+ * @param error  Where to put the error message
+ * @return       false on EOF or a malformed request
+ */
+static bool server_read_request(FILE *pin, server_request& req,
+                                const char *& error)
+{
+   char          line[256];
+   unsigned long len = 0;
+   int           cnt;
+
+   error = NULL;
+   if (fgets(line, sizeof(line), pin) == NULL)
+   {
+      return(false);
+   }
+
+   req.lang[0] = 0;
+   cnt         = sscanf(line, "%15s %15s %lu", req.cmd, req.lang, &len);
+   if (cnt < 1)
+   {
+      LOG_FMT(LERR, "%s: bad request header '%s'\n", __func__, line);
+      error = "bad request header";
+      return(false);
+   }
+   if (strcmp(req.cmd, "QUIT") == 0)
+   {
+      req.payload.clear();
+      return(true);
+   }
+   if (cnt != 3)
+   {
+      LOG_FMT(LERR, "%s: bad request header '%s'\n", __func__, line);
+      error = "bad request header";
+      return(false);
+   }
+
+   /* The payload can't be skipped, so the session can't go on after this */
+   if (len > SERVER_MAX_PAYLOAD)
+   {
+      LOG_FMT(LERR, "%s: payload of %lu bytes is over the limit of %lu\n",
+              __func__, len, SERVER_MAX_PAYLOAD);
+      error = "payload is too large";
+      return(false);
+   }
+   try
+   {
+      req.payload.resize(len);
+   }
+   catch (const std::bad_alloc&)
+   {
+      LOG_FMT(LERR, "%s: out of memory for %lu bytes\n", __func__, len);
+      error = "out of memory";
+      return(false);
+   }
+   if ((len > 0) && (fread(&req.payload[0], len, 1, pin) != 1))
+   {
+      LOG_FMT(LERR, "%s: short payload, expected %lu bytes\n", __func__, len);
+      error = "short payload";
+      return(false);
+   }
+   return(true);
+}
+
+
+/**
+ * Sends a reply.
+ *
+ * @return false if the reply could not be written
+ */
+static bool server_reply(FILE *pout, const char *status,
+                         const void *data, size_t len)
+{
+   fprintf(pout, "%s %lu\n", status, (unsigned long)len);
+   if (len > 0)
+   {
+      fwrite(data, len, 1, pout);
+   }
+   return((fflush(pout) == 0) && !ferror(pout));
+}
+
+
+static bool server_error(FILE *pout, const char *msg)
+{
+   return(server_reply(pout, "ERROR", msg, strlen(msg)));
+}
+
+
+/**
+ * Formats the source for a TEXT or FILE request and sends the reply.
+ *
+ * @param start_lang  The language from the command line, used for '-' if
+ *                    it was forced with '-l'
+ */
+static bool server_format(server_request& req, FILE *pout, int start_lang)
+{
+   file_mem fm;
+   string   filename;
+
+   if (strcmp(req.cmd, "FILE") == 0)
+   {
+      filename.assign(req.payload.begin(), req.payload.end());
+      if (load_mem_file(filename.c_str(), fm) < 0)
+      {
+         LOG_FMT(LERR, "Failed to load (%s)\n", filename.c_str());
+         return(server_error(pout, "failed to load the file"));
+      }
+   }
+   else if (strcmp(req.cmd, "TEXT") == 0)
+   {
+      filename = "stdin";
+      fm.raw.swap(req.payload);
+      if (!decode_file(fm))
+      {
+         return(server_error(pout, "failed to decode the text"));
+      }
+   }
+   else
+   {
+      return(server_error(pout, "unknown request"));
+   }
+
+   /* Pick the language, like the command line does */
+   if (strcmp(req.lang, "-") != 0)
+   {
+      cpd.lang_flags = language_from_tag(req.lang);
+      if (cpd.lang_flags == 0)
+      {
+         return(server_error(pout, "unknown language"));
+      }
+   }
+   else if (cpd.lang_forced)
+   {
+      cpd.lang_flags = start_lang;
+   }
+   else
+   {
+      cpd.lang_flags = (filename == "stdin") ? LANG_C :
+                       language_from_filename(filename.c_str());
+   }
+
+   /* The name is only good for this request */
+   const char *old_filename = cpd.filename;
+
+   cpd.filename = filename.c_str();
+   LOG_FMT(LSYS, "Parsing: %s as language %s\n",
+           cpd.filename, language_to_string(cpd.lang_flags));
+
+   /* Render to memory so that the length is known before sending */
+   vector<UINT8> out;
+   UINT32        errors = cpd.error_count;
+
+   uncrustify_file(fm, &out, NULL);
+   cpd.filename = old_filename;
+
+   if ((cpd.error_count != errors) && (out.size() == 0))
+   {
+      return(server_error(pout, "failed to format"));
+   }
+   return(server_reply(pout, "OK", (out.size() > 0) ? &out[0] : NULL,
+                       out.size()));
+}
+
+
+/**
+ * Handles requests until EOF, QUIT or a write error.
+ */
+static void server_session(FILE *pin, FILE *pout)
+{
+   server_request req;
+   int            start_lang = cpd.lang_flags;
+   const char     *error;
+
+   while (server_read_request(pin, req, error))
+   {
+      if (strcmp(req.cmd, "QUIT") == 0)
+      {
+         break;
+      }
+      if (!server_format(req, pout, start_lang))
+      {
+         break;
+      }
+   }
+   if (error != NULL)
+   {
+      (void)server_error(pout, error);
+   }
+}
+
+
+#ifndef WIN32
+
+/**
+ * Thread entry for a socket connection.
+ * Each connection gets its own copy of the configured context.
+ */
+static void server_connection(int fd, const cp_data *cfg)
+{
+   cpd = *cfg;
+
+   FILE *pin  = fdopen(fd, "rb");
+   FILE *pout = fdopen(dup(fd), "wb");
+
+   if ((pin != NULL) && (pout != NULL))
+   {
+      server_session(pin, pout);
+   }
+   if (pout != NULL)
+   {
+      fclose(pout);
+   }
+   if (pin != NULL)
+   {
+      fclose(pin);
+   }
+   else
+   {
+      close(fd);
+   }
+}
+
+
+static int server_listen(const char *socket_path)
+{
+   struct sockaddr_un addr;
+   struct stat        my_stat;
+   int                fd;
+
+   if (strlen(socket_path) >= sizeof(addr.sun_path))
+   {
+      LOG_FMT(LERR, "%s: socket path is too long: %s\n", __func__, socket_path);
+      return(EXIT_FAILURE);
+   }
+
+   /* Remove a stale socket from a previous run */
+   if ((stat(socket_path, &my_stat) == 0) && S_ISSOCK(my_stat.st_mode))
+   {
+      (void)unlink(socket_path);
+   }
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0)
+   {
+      LOG_FMT(LERR, "%s: socket() failed: %s (%d)\n",
+              __func__, strerror(errno), errno);
+      return(EXIT_FAILURE);
+   }
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strcpy(addr.sun_path, socket_path);
+
+   /* Only the user may connect, the socket is created with the umask */
+   mode_t old_mask = umask(0077);
+   int    res      = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+   umask(old_mask);
+
+   if ((res != 0) || (listen(fd, 16) != 0))
+   {
+      LOG_FMT(LERR, "%s: unable to listen on %s: %s (%d)\n",
+              __func__, socket_path, strerror(errno), errno);
+      close(fd);
+      return(EXIT_FAILURE);
+   }
+
+   /* A client that goes away shouldn't kill the server */
+   signal(SIGPIPE, SIG_IGN);
+
+   LOG_FMT(LNOTE, "Listening on %s\n", socket_path);
+
+   while (true)
+   {
+      int cfd = accept(fd, NULL, NULL);
+      if (cfd < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         LOG_FMT(LERR, "%s: accept() failed: %s (%d)\n",
+                 __func__, strerror(errno), errno);
+         break;
+      }
+      try
+      {
+         thread(server_connection, cfd, &cpd).detach();
+      }
+      catch (const system_error& ex)
+      {
+         /* Out of threads: drop this client, the next one may get one */
+         LOG_FMT(LERR, "%s: unable to start a thread: %s\n",
+                 __func__, ex.what());
+         close(cfd);
+      }
+   }
+
+   close(fd);
+   (void)unlink(socket_path);
+   return(EXIT_FAILURE);
+}
+
+#endif /* ifndef WIN32 */
+
+
+int server_main(const char *socket_path)
+{
+   if (socket_path == NULL)
+   {
+      server_session(stdin, stdout);
+      return(EXIT_SUCCESS);
+   }
+#ifndef WIN32
+   return(server_listen(socket_path));
+#else
+   LOG_FMT(LERR, "%s: sockets are not supported on this platform\n", __func__);
+   return(EXIT_FAILURE);
+#endif
+}
@@ -0,0 +1,51 @@
+/**
+ * @file server.h
+ * Runs uncrustify as a formatting server.
+ *
+ * The config, type, define and header files are loaded once at startup and
+ * then any number of format requests are handled, which avoids starting a
+ * new process for each file.
+ *
+ * The protocol is the same on stdin/stdout and on a Unix domain socket.
+ * Each message is a single header line followed by a payload of exactly the
+ * number of bytes given in the header.
+ *
+ * Requests:
+ *   TEXT LANG LEN\n<LEN bytes>  - format the source code in the payload
+ *   FILE LANG LEN\n<LEN bytes>  - format the file named in the payload
+ *   QUIT\n                      - end the session
+ *
+ * LANG is a language tag as used with '-l' or '-' to pick the language from
+ * the filename (FILE) or the '-l' option (TEXT, defaults to C).
+ * A FILE request does not modify the file.
+ * LEN may be at most 64 MB.
+ *
+ * Replies:
+ *   OK LEN\n<LEN bytes>         - the formatted text
+ *   ERROR LEN\n<LEN bytes>      - an error message
+ *
+ * A malformed header, a LEN over the limit or a short payload gets an ERROR
+ * reply and then ends the session, as the rest of the input can't be framed.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef SERVER_H_INCLUDED
+#define SERVER_H_INCLUDED
+
+
+/**
+ * Handles format requests until the input is closed or QUIT is received.
+ * If socket_path is NULL, then the requests are read from stdin and the
+ * replies go to stdout. Otherwise a Unix domain socket is created at
+ * socket_path and each connection is served by its own thread.
+ *
+ * The config must already be loaded.
+ *
+ * @param socket_path  NULL or the socket to listen on
+ * @return             EXIT_SUCCESS or EXIT_FAILURE
+ */
+int server_main(const char *socket_path);
+
+
+#endif /* SERVER_H_INCLUDED */
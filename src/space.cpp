@@ -260,6 +260,7 @@ static argval_t do_space(chunk_t *first, chunk_t *second, int& min_sp, bool comp
       if (cpd.settings[UO_sp_endif_cmt].a != AV_IGNORE)
       {
          second->type = CT_COMMENT_ENDIF;
+         chunk_nav_changed();
          log_rule("sp_endif_cmt");
          return(cpd.settings[UO_sp_endif_cmt].a);
       }
@@ -1429,9 +1430,7 @@ void space_text(void)
 
       /* If the current chunk contains a newline, do not change the column
        * of the next item */
-      if ((pc->type == CT_NEWLINE) ||
-          (pc->type == CT_NL_CONT) ||
-          (pc->type == CT_COMMENT_MULTI))
+      if (chunk_is_newline(pc) || (pc->type == CT_COMMENT_MULTI))
       {
          column = next->column;
       }
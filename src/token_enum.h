@@ -14,7 +14,7 @@
  * each chunk/token.
  *
  * The script 'make_token_names.sh' creates token_names.h, so be sure to run
- * that after adding or removing an entry.
+ * that after adding or removing an entry or changing the token classes.
  */
 typedef enum
 {
@@ -297,4 +297,31 @@ typedef enum
    CT_ASSERT,           /* assert EXP1 [ : EXP2 ] ; */
 } c_token_t;
 
+/**
+ * Token classes, so that a check for any of several tokens is one table
+ * lookup. make_token_names.sh lists the tokens in each class and creates
+ * token_flags[] from that list.
+ */
+#define TKF_COMMENT        (1 << 0)   /* COMMENT, COMMENT_MULTI, COMMENT_CPP */
+#define TKF_SL_COMMENT     (1 << 1)   /* COMMENT, COMMENT_CPP */
+#define TKF_NEWLINE        (1 << 2)   /* NEWLINE, NL_CONT */
+#define TKF_SEMICOLON      (1 << 3)   /* SEMICOLON, VSEMICOLON */
+#define TKF_TYPE           (1 << 4)   /* a type or part of one */
+#define TKF_BRACE_OPEN     (1 << 5)   /* BRACE_OPEN, VBRACE_OPEN */
+#define TKF_BRACE_CLOSE    (1 << 6)   /* BRACE_CLOSE, VBRACE_CLOSE */
+#define TKF_VBRACE         (1 << 7)   /* VBRACE_OPEN, VBRACE_CLOSE */
+#define TKF_PAREN_OPEN     (1 << 8)   /* PAREN_OPEN, SPAREN_OPEN, FPAREN_OPEN */
+#define TKF_PAREN_CLOSE    (1 << 9)   /* PAREN_CLOSE, SPAREN_CLOSE, FPAREN_CLOSE */
+#define TKF_OPENER         (1 << 10)  /* a paren, brace or square that has a match */
+#define TKF_CLOSER         (1 << 11)  /* the match of a TKF_OPENER */
+#define TKF_PREPROC        (1 << 12)  /* a preprocessor directive, PP_xxx */
+
+extern const UINT32 token_flags[];
+
+static_inline
+bool token_is(c_token_t type, UINT32 flags)
+{
+   return((token_flags[type] & flags) != 0);
+}
+
 #endif   /* TOKEN_ENUM_H_INCLUDED */
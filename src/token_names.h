@@ -1,5 +1,5 @@
 /*
- * Generated by make_token_names.sh on Thu Mar 29 19:21:45 CDT 2012
+ * Generated by make_token_names.sh on Fri Oct 16 19:47:08 UTC 2026
  */
 #ifndef TOKEN_NAMES_H_INCLUDED
 #define TOKEN_NAMES_H_INCLUDED
@@ -249,4 +249,249 @@ const char *token_names[] =
    "ASSERT",
 };
 
+const UINT32 token_flags[] =
+{
+   0,                                       /* NONE */
+   0,                                       /* EOF */
+   0,                                       /* UNKNOWN */
+   0,                                       /* JUNK */
+   0,                                       /* WHITESPACE */
+   0,                                       /* SPACE */
+   TKF_NEWLINE,                             /* NEWLINE */
+   TKF_NEWLINE,                             /* NL_CONT */
+   TKF_COMMENT | TKF_SL_COMMENT,            /* COMMENT_CPP */
+   TKF_COMMENT | TKF_SL_COMMENT,            /* COMMENT */
+   TKF_COMMENT,                             /* COMMENT_MULTI */
+   0,                                       /* COMMENT_EMBED */
+   0,                                       /* COMMENT_START */
+   0,                                       /* COMMENT_END */
+   0,                                       /* COMMENT_WHOLE */
+   0,                                       /* COMMENT_ENDIF */
+   0,                                       /* IGNORED */
+   0,                                       /* WORD */
+   0,                                       /* NUMBER */
+   0,                                       /* NUMBER_FP */
+   0,                                       /* STRING */
+   0,                                       /* STRING_MULTI */
+   0,                                       /* IF */
+   0,                                       /* ELSE */
+   0,                                       /* ELSEIF */
+   0,                                       /* FOR */
+   0,                                       /* WHILE */
+   0,                                       /* WHILE_OF_DO */
+   0,                                       /* SWITCH */
+   0,                                       /* CASE */
+   0,                                       /* DO */
+   0,                                       /* VOLATILE */
+   0,                                       /* TYPEDEF */
+   TKF_TYPE,                                /* STRUCT */
+   TKF_TYPE,                                /* ENUM */
+   0,                                       /* SIZEOF */
+   0,                                       /* RETURN */
+   0,                                       /* BREAK */
+   TKF_TYPE,                                /* UNION */
+   0,                                       /* GOTO */
+   0,                                       /* CONTINUE */
+   0,                                       /* C_CAST */
+   0,                                       /* CPP_CAST */
+   0,                                       /* D_CAST */
+   0,                                       /* TYPE_CAST */
+   0,                                       /* TYPENAME */
+   0,                                       /* TEMPLATE */
+   0,                                       /* ASSIGN */
+   0,                                       /* ASSIGN_NL */
+   0,                                       /* SASSIGN */
+   0,                                       /* COMPARE */
+   0,                                       /* SCOMPARE */
+   0,                                       /* BOOL */
+   0,                                       /* SBOOL */
+   0,                                       /* ARITH */
+   0,                                       /* SARITH */
+   0,                                       /* DEREF */
+   0,                                       /* INCDEC_BEFORE */
+   0,                                       /* INCDEC_AFTER */
+   0,                                       /* MEMBER */
+   TKF_TYPE,                                /* DC_MEMBER */
+   0,                                       /* C99_MEMBER */
+   0,                                       /* INV */
+   0,                                       /* DESTRUCTOR */
+   0,                                       /* NOT */
+   0,                                       /* D_TEMPLATE */
+   0,                                       /* ADDR */
+   0,                                       /* NEG */
+   0,                                       /* POS */
+   0,                                       /* STAR */
+   0,                                       /* PLUS */
+   0,                                       /* MINUS */
+   0,                                       /* AMP */
+   TKF_TYPE,                                /* BYREF */
+   0,                                       /* POUND */
+   0,                                       /* PREPROC */
+   0,                                       /* PREPROC_INDENT */
+   0,                                       /* PREPROC_BODY */
+   0,                                       /* PP */
+   0,                                       /* ELLIPSIS */
+   0,                                       /* RANGE */
+   TKF_SEMICOLON,                           /* SEMICOLON */
+   TKF_SEMICOLON,                           /* VSEMICOLON */
+   0,                                       /* COLON */
+   0,                                       /* CASE_COLON */
+   0,                                       /* CLASS_COLON */
+   0,                                       /* D_ARRAY_COLON */
+   0,                                       /* COND_COLON */
+   0,                                       /* QUESTION */
+   0,                                       /* COMMA */
+   0,                                       /* ASM */
+   0,                                       /* ATTRIBUTE */
+   0,                                       /* CATCH */
+   0,                                       /* CLASS */
+   0,                                       /* DELETE */
+   0,                                       /* EXPORT */
+   0,                                       /* FRIEND */
+   0,                                       /* NAMESPACE */
+   0,                                       /* NEW */
+   0,                                       /* OPERATOR */
+   0,                                       /* OPERATOR_VAL */
+   0,                                       /* PRIVATE */
+   0,                                       /* PRIVATE_COLON */
+   0,                                       /* THROW */
+   0,                                       /* TRY */
+   0,                                       /* USING */
+   0,                                       /* USING_STMT */
+   0,                                       /* D_WITH */
+   0,                                       /* D_MODULE */
+   0,                                       /* SUPER */
+   0,                                       /* DELEGATE */
+   0,                                       /* BODY */
+   0,                                       /* DEBUG */
+   0,                                       /* DEBUGGER */
+   0,                                       /* INVARIANT */
+   0,                                       /* UNITTEST */
+   0,                                       /* UNSAFE */
+   0,                                       /* FINALLY */
+   0,                                       /* IMPORT */
+   0,                                       /* D_SCOPE */
+   0,                                       /* D_SCOPE_IF */
+   0,                                       /* LAZY */
+   0,                                       /* D_MACRO */
+   0,                                       /* D_VERSION */
+   0,                                       /* D_VERSION_IF */
+   TKF_PAREN_OPEN | TKF_OPENER,             /* PAREN_OPEN */
+   TKF_PAREN_CLOSE | TKF_CLOSER,            /* PAREN_CLOSE */
+   0,                                       /* ANGLE_OPEN */
+   0,                                       /* ANGLE_CLOSE */
+   TKF_PAREN_OPEN | TKF_OPENER,             /* SPAREN_OPEN */
+   TKF_PAREN_CLOSE | TKF_CLOSER,            /* SPAREN_CLOSE */
+   TKF_PAREN_OPEN | TKF_OPENER,             /* FPAREN_OPEN */
+   TKF_PAREN_CLOSE | TKF_CLOSER,            /* FPAREN_CLOSE */
+   TKF_BRACE_OPEN | TKF_OPENER,             /* BRACE_OPEN */
+   TKF_BRACE_CLOSE | TKF_CLOSER,            /* BRACE_CLOSE */
+   TKF_BRACE_OPEN | TKF_VBRACE | TKF_OPENER, /* VBRACE_OPEN */
+   TKF_BRACE_CLOSE | TKF_VBRACE | TKF_CLOSER, /* VBRACE_CLOSE */
+   TKF_OPENER,                              /* SQUARE_OPEN */
+   TKF_CLOSER,                              /* SQUARE_CLOSE */
+   0,                                       /* TSQUARE */
+   0,                                       /* MACRO_OPEN */
+   0,                                       /* MACRO_CLOSE */
+   0,                                       /* MACRO_ELSE */
+   0,                                       /* LABEL */
+   0,                                       /* LABEL_COLON */
+   0,                                       /* FUNCTION */
+   0,                                       /* FUNC_CALL */
+   0,                                       /* FUNC_CALL_USER */
+   0,                                       /* FUNC_DEF */
+   0,                                       /* FUNC_PROTO */
+   0,                                       /* FUNC_CLASS */
+   0,                                       /* FUNC_CTOR_VAR */
+   0,                                       /* FUNC_WRAP */
+   0,                                       /* PROTO_WRAP */
+   0,                                       /* MACRO_FUNC */
+   0,                                       /* MACRO */
+   TKF_TYPE,                                /* QUALIFIER */
+   0,                                       /* EXTERN */
+   0,                                       /* ALIGN */
+   TKF_TYPE,                                /* TYPE */
+   TKF_TYPE,                                /* PTR_TYPE */
+   0,                                       /* TYPE_WRAP */
+   0,                                       /* CPP_LAMBDA */
+   0,                                       /* CPP_LAMBDA_RET */
+   0,                                       /* BIT_COLON */
+   0,                                       /* OC_DYNAMIC */
+   0,                                       /* OC_END */
+   0,                                       /* OC_IMPL */
+   0,                                       /* OC_INTF */
+   0,                                       /* OC_PROTOCOL */
+   0,                                       /* OC_PROTO_LIST */
+   0,                                       /* OC_PROPERTY */
+   0,                                       /* OC_CLASS */
+   0,                                       /* OC_CLASS_EXT */
+   0,                                       /* OC_CATEGORY */
+   0,                                       /* OC_SCOPE */
+   0,                                       /* OC_MSG */
+   0,                                       /* OC_MSG_CLASS */
+   0,                                       /* OC_MSG_FUNC */
+   0,                                       /* OC_MSG_NAME */
+   0,                                       /* OC_MSG_SPEC */
+   0,                                       /* OC_MSG_DECL */
+   0,                                       /* OC_RTYPE */
+   0,                                       /* OC_COLON */
+   0,                                       /* OC_SEL */
+   0,                                       /* OC_SEL_NAME */
+   0,                                       /* OC_BLOCK_ARG */
+   0,                                       /* OC_BLOCK_TYPE */
+   0,                                       /* OC_BLOCK_EXPR */
+   0,                                       /* OC_BLOCK_CARET */
+   TKF_PREPROC,                             /* PP_DEFINE */
+   TKF_PREPROC,                             /* PP_DEFINED */
+   TKF_PREPROC,                             /* PP_INCLUDE */
+   TKF_PREPROC,                             /* PP_IF */
+   TKF_PREPROC,                             /* PP_ELSE */
+   TKF_PREPROC,                             /* PP_ENDIF */
+   TKF_PREPROC,                             /* PP_ASSERT */
+   TKF_PREPROC,                             /* PP_EMIT */
+   TKF_PREPROC,                             /* PP_ENDINPUT */
+   TKF_PREPROC,                             /* PP_ERROR */
+   TKF_PREPROC,                             /* PP_FILE */
+   TKF_PREPROC,                             /* PP_LINE */
+   TKF_PREPROC,                             /* PP_SECTION */
+   TKF_PREPROC,                             /* PP_UNDEF */
+   TKF_PREPROC,                             /* PP_BODYCHUNK */
+   TKF_PREPROC,                             /* PP_PRAGMA */
+   TKF_PREPROC,                             /* PP_REGION */
+   TKF_PREPROC,                             /* PP_ENDREGION */
+   TKF_PREPROC,                             /* PP_REGION_INDENT */
+   TKF_PREPROC,                             /* PP_IF_INDENT */
+   TKF_PREPROC,                             /* PP_OTHER */
+   0,                                       /* CHAR */
+   0,                                       /* DEFINED */
+   0,                                       /* FORWARD */
+   0,                                       /* NATIVE */
+   0,                                       /* STATE */
+   0,                                       /* STOCK */
+   0,                                       /* TAGOF */
+   0,                                       /* DOT */
+   0,                                       /* TAG */
+   0,                                       /* TAG_COLON */
+   0,                                       /* LOCK */
+   0,                                       /* AS */
+   0,                                       /* IN */
+   0,                                       /* BRACED */
+   0,                                       /* THIS */
+   0,                                       /* BASE */
+   0,                                       /* DEFAULT */
+   0,                                       /* GETSET */
+   0,                                       /* GETSET_EMPTY */
+   0,                                       /* CONCAT */
+   0,                                       /* CS_SQ_STMT */
+   0,                                       /* CS_SQ_COLON */
+   0,                                       /* CS_PROPERTY */
+   0,                                       /* SQL_EXEC */
+   0,                                       /* SQL_BEGIN */
+   0,                                       /* SQL_END */
+   0,                                       /* SQL_WORD */
+   0,                                       /* CONSTRUCT */
+   0,                                       /* LAMBDA */
+   0,                                       /* ASSERT */
+};
+
 #endif /* TOKEN_NAMES_H_INCLUDED */
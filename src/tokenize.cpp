@@ -30,8 +30,63 @@ struct tok_info
 
 struct tok_ctx
 {
-   tok_ctx(const deque<int>& d) : data(d)
+   tok_ctx(const file_mem& fm)
+      : data(fm.data), bytes((fm.ascii || fm.utf8) ? fm.bytes() : NULL),
+      utf8(fm.utf8), len((bytes != NULL) ? fm.size() : fm.data.size())
    {
+      c.idx = fm.text_start();
+   }
+
+   /* The char at idx, which must be less than len */
+   int char_at(int idx) const
+   {
+      if (bytes == NULL)
+      {
+         return(data[idx]);
+      }
+      return((bytes[idx] < 0x80) ? bytes[idx] : utf8_at(idx));
+   }
+
+   /* The number of units of the input that the char at idx takes */
+   int char_len(int idx) const
+   {
+      return((utf8 && (bytes[idx] >= 0x80)) ? (utf8_tail(bytes[idx]) + 1) : 1);
+   }
+
+   /* The number of bytes that follow a UTF-8 lead byte */
+   static int utf8_tail(int lead)
+   {
+      return((lead < 0xE0) ? 1 : (lead < 0xF0) ? 2 : (lead < 0xF8) ? 3 : (lead < 0xFC) ? 4 : 5);
+   }
+
+   /* Decodes the UTF-8 sequence at idx, which decode_file() has checked */
+   int utf8_at(int idx) const
+   {
+      int cnt = utf8_tail(bytes[idx]);
+      int ch  = bytes[idx] & (0x3F >> cnt);
+
+      while (cnt-- > 0)
+      {
+         ch = (ch << 6) | (bytes[++idx] & 0x3F);
+      }
+      return(ch);
+   }
+
+   /**
+    * Empties the token text. Input that is read from the bytes is referenced
+    * instead of copied, for as long as the chars appended to the text are the
+    * next ones in the input and are plain ASCII.
+    */
+   void start_text(unc_text& str) const
+   {
+      if (bytes != NULL)
+      {
+         str.set_ref(bytes + c.idx, 0, len - c.idx);
+      }
+      else
+      {
+         str.clear();
+      }
    }
 
    /* save before trying to parse something that may fail */
@@ -56,25 +111,38 @@ struct tok_ctx
 
    bool more()
    {
-      return(c.idx < (int)data.size());
+      return(c.idx < len);
    }
 
    int peek()
    {
-      return(more() ? data[c.idx] : -1);
+      return(more() ? char_at(c.idx) : -1);
    }
 
    int peek(int idx)
    {
-      idx += c.idx;
-      return((idx < (int)data.size()) ? data[idx] : -1);
+      int pos = c.idx;
+
+      if (utf8)
+      {
+         while ((idx-- > 0) && (pos < len))
+         {
+            pos += char_len(pos);
+         }
+      }
+      else
+      {
+         pos += idx;
+      }
+      return((pos < len) ? char_at(pos) : -1);
    }
 
    int get()
    {
       if (more())
       {
-         int ch = data[c.idx++];
+         int ch = char_at(c.idx);
+         c.idx += (ch < 0x80) ? 1 : char_len(c.idx);
          switch (ch)
          {
          case '\t':
@@ -114,9 +182,12 @@ struct tok_ctx
       return false;
    }
 
-   const deque<int>& data;
-   tok_info          c; /* current */
-   tok_info          s; /* saved */
+   const vector<int>& data;  /* the decoded text, unless it is in bytes */
+   const UINT8        *bytes; /* NULL or the plain ASCII or UTF-8 text */
+   bool               utf8;   /* bytes may hold multi-byte chars */
+   int                len;    /* of bytes or data */
+   tok_info           c;      /* current */
+   tok_info           s;      /* saved */
 };
 
 static bool parse_string(tok_ctx& ctx, chunk_t& pc, int quote_idx, bool allow_escape);
@@ -155,7 +226,7 @@ static bool d_parse_string(tok_ctx& ctx, chunk_t& pc)
    {
       ctx.save();
       int cnt;
-      pc.str.clear();
+      ctx.start_text(pc.str);
       while (ctx.peek() == '\\')
       {
          pc.str.append(ctx.get());
@@ -294,7 +365,8 @@ static bool parse_comment(tok_ctx& ctx, chunk_t& pc)
    ctx.save();
 
    /* account for opening two chars */
-   pc.str = ctx.get();   /* opening '/' */
+   ctx.start_text(pc.str);
+   pc.str.append(ctx.get());   /* opening '/' */
 
    ch = ctx.peek();
    if (ch == '/')
@@ -741,7 +813,7 @@ static bool parse_string(tok_ctx& ctx, chunk_t& pc, int quote_idx, bool allow_es
    char escape_char  = cpd.settings[UO_string_escape_char].n;
    char escape_char2 = cpd.settings[UO_string_escape_char2].n;
 
-   pc.str.clear();
+   ctx.start_text(pc.str);
    while (quote_idx-- > 0)
    {
       pc.str.append(ctx.get());
@@ -805,7 +877,8 @@ static bool parse_string(tok_ctx& ctx, chunk_t& pc, int quote_idx, bool allow_es
  */
 static bool parse_cs_string(tok_ctx& ctx, chunk_t& pc)
 {
-   pc.str = ctx.get();
+   ctx.start_text(pc.str);
+   pc.str.append(ctx.get());
    pc.str.append(ctx.get());
 
    /* go until we hit a zero (end of file) or a single " */
@@ -831,13 +904,13 @@ static bool parse_cs_string(tok_ctx& ctx, chunk_t& pc)
 }
 
 
-static bool tag_compare(const deque<int>& d, int a_idx, int b_idx, int len)
+static bool tag_compare(const tok_ctx& ctx, int a_idx, int b_idx, int len)
 {
    if (a_idx != b_idx)
    {
       while (len-- > 0)
       {
-         if (d[a_idx] != d[b_idx])
+         if (ctx.char_at(a_idx) != ctx.char_at(b_idx))
          {
             return false;
          }
@@ -860,7 +933,7 @@ static bool parse_cr_string(tok_ctx& ctx, chunk_t& pc, int q_idx)
    ctx.save();
 
    /* Copy the prefix + " to the string */
-   pc.str.clear();
+   ctx.start_text(pc.str);
    cnt = q_idx + 1;
    while (cnt--)
    {
@@ -884,7 +957,7 @@ static bool parse_cr_string(tok_ctx& ctx, chunk_t& pc, int q_idx)
    {
       if ((ctx.peek() == ')') &&
           (ctx.peek(tag_len + 1) == '"') &&
-          tag_compare(ctx.data, tag_idx, ctx.c.idx + 1, tag_len))
+          tag_compare(ctx, tag_idx, ctx.c.idx + 1, tag_len))
       {
          cnt = tag_len + 2;   /* for the )" */
          while (cnt--)
@@ -922,7 +995,7 @@ bool parse_word(tok_ctx& ctx, chunk_t& pc, bool skipcheck)
    int ch;
 
    /* The first character is already valid */
-   pc.str.clear();
+   ctx.start_text(pc.str);
    pc.str.append(ctx.get());
 
    while (ctx.more() && CharTable::IsKw2(ctx.peek()))
@@ -937,6 +1010,7 @@ bool parse_word(tok_ctx& ctx, chunk_t& pc, bool skipcheck)
       }
    }
    pc.type = CT_WORD;
+   pc.str.intern();
 
    if (skipcheck)
    {
@@ -959,7 +1033,7 @@ bool parse_word(tok_ctx& ctx, chunk_t& pc, bool skipcheck)
    else
    {
       /* Turn it into a keyword now */
-      pc.type = find_keyword_type(pc.str.c_str(), pc.str.size());
+      pc.type = find_keyword_type(pc.str);
    }
 
    return(true);
@@ -1109,7 +1183,7 @@ static bool parse_ignored(tok_ctx& ctx, chunk_t& pc)
 
    /* See if the INDENT-ON text is on this line */
    ctx.save();
-   pc.str.clear();
+   ctx.start_text(pc.str);
    while (ctx.more() &&
           (ctx.peek() != '\r') &&
           (ctx.peek() != '\n'))
@@ -1143,7 +1217,7 @@ static bool parse_ignored(tok_ctx& ctx, chunk_t& pc)
    }
 
    /* Reset the chunk & scan to until a newline */
-   pc.str.clear();
+   ctx.start_text(pc.str);
    while (ctx.more() &&
           (ctx.peek() != '\r') &&
           (ctx.peek() != '\n'))
@@ -1188,6 +1262,7 @@ static bool parse_next(tok_ctx& ctx, chunk_t& pc)
    pc.type      = CT_NONE;
    pc.nl_count  = 0;
    pc.flags     = 0;
+   ctx.start_text(pc.str);
 
    /* If it is turned off, we put everything except newlines into CT_UNKNOWN */
    if (cpd.unc_off)
@@ -1212,7 +1287,7 @@ static bool parse_next(tok_ctx& ctx, chunk_t& pc)
    if ((cpd.in_preproc > CT_PP_BODYCHUNK) &&
        (cpd.in_preproc <= CT_PP_OTHER))
    {
-      pc.str.clear();
+      ctx.start_text(pc.str);
       tok_info ss;
       ctx.save(ss);
       /* Chunk to a newline or comment */
@@ -1406,13 +1481,21 @@ static bool parse_next(tok_ctx& ctx, chunk_t& pc)
       return(true);
    }
 
-   /* see if we have a punctuator */
-   char punc_txt[4];
-   punc_txt[0] = ctx.peek();
-   punc_txt[1] = ctx.peek(1);
-   punc_txt[2] = ctx.peek(2);
-   punc_txt[3] = ctx.peek(3);
-   if ((punc = find_punctuator(punc_txt, cpd.lang_flags)) != NULL)
+   /* see if we have a punctuator, the bytes are matched in place */
+   if (ctx.bytes != NULL)
+   {
+      punc = find_punctuator(ctx.bytes + ctx.c.idx, ctx.len - ctx.c.idx, cpd.lang_flags);
+   }
+   else
+   {
+      UINT8 punc_txt[4];
+      for (int idx = 0; idx < 4; idx++)
+      {
+         punc_txt[idx] = ctx.peek(idx);
+      }
+      punc = find_punctuator(punc_txt, 4, cpd.lang_flags);
+   }
+   if (punc != NULL)
    {
       int cnt = strlen(punc->tag);
       while (cnt--)
@@ -1446,17 +1529,14 @@ static bool parse_next(tok_ctx& ctx, chunk_t& pc)
  * All the tokens are inserted before ref. If ref is NULL, they are inserted
  * at the end of the list.  Line numbers are relative to the start of the data.
  */
-void tokenize(const deque<int>& data, chunk_t *ref)
+void tokenize(const file_mem& fm, chunk_t *ref)
 {
-   tok_ctx            ctx(data);
+   tok_ctx            ctx(fm);
    chunk_t            chunk;
    chunk_t            *pc    = NULL;
    chunk_t            *rprev = NULL;
-   struct parse_frame frm;
    bool               last_was_tab = false;
 
-   memset(&frm, 0, sizeof(frm));
-
    while (ctx.more())
    {
       chunk.reset();
@@ -1518,7 +1598,8 @@ void tokenize(const deque<int>& data, chunk_t *ref)
       }
       if (ref != NULL)
       {
-         chunk.flags |= PCF_INSERTED;
+         /* Inserted text goes with the '--lines' region of ref */
+         chunk.flags |= PCF_INSERTED | (ref->flags & (PCF_IN_LINES | PCF_LINES_CTX));
       }
       else
       {
@@ -1547,7 +1628,7 @@ void tokenize(const deque<int>& data, chunk_t *ref)
          /* Figure out the type of preprocessor for #include parsing */
          if (cpd.in_preproc == CT_PREPROC)
          {
-            if ((pc->type < CT_PP_DEFINE) || (pc->type > CT_PP_OTHER))
+            if (!token_is(pc->type, TKF_PREPROC))
             {
                pc->type = CT_PP_OTHER;
             }
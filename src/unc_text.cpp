@@ -7,6 +7,9 @@
  */
 #include "unc_text.h"
 #include "prototypes.h" /* encode_utf8() */
+#include "unc_ctype.h"
+#include <algorithm>
+#include <unordered_map>
 
 static void fix_len_idx(int size, int& idx, int& len)
 {
@@ -41,24 +44,198 @@ static void fix_len_idx(int size, int& idx, int& len)
    }
 }
 
-void unc_text::update_logtext()
+/**
+ * The symbol table of a thread.
+ * The text of symbol N is chars[start[N]] up to chars[start[N + 1]].
+ * Symbol 0 isn't used, so that 0 can mean 'not interned'.
+ * The slots are an open addressing hash of the symbol numbers, which is
+ * kept at most half full.
+ */
+struct sym_table
+{
+   vector<int>    chars;
+   vector<UINT32> start;
+   vector<UINT32> hash;
+   vector<UINT32> slots;
+
+   sym_table() : start(2, 0), hash(1, 0), slots(1024, 0)
+   {
+   }
+
+   UINT32 count() const
+   {
+      return(hash.size() - 1);
+   }
+
+   void clear()
+   {
+      chars.clear();
+      start.resize(2);
+      hash.resize(1);
+      fill(slots.begin(), slots.end(), 0);
+   }
+
+   void grow()
+   {
+      vector<UINT32> old_slots;
+
+      old_slots.swap(slots);
+      slots.assign(old_slots.size() * 2, 0);
+      UINT32 mask = slots.size() - 1;
+      for (size_t idx = 0; idx < old_slots.size(); idx++)
+      {
+         UINT32 sym = old_slots[idx];
+         if (sym != 0)
+         {
+            UINT32 slot = hash[sym] & mask;
+            while (slots[slot] != 0)
+            {
+               slot = (slot + 1) & mask;
+            }
+            slots[slot] = sym;
+         }
+      }
+   }
+};
+
+static thread_local sym_table g_syms;
+
+/**
+ * The UTF-8 logging text of the unc_text objects of a thread that asked for
+ * it, see c_str(). Most texts are never logged, so the buffers are kept here
+ * instead of in every unc_text.
+ * An entry is left behind when its unc_text goes away and may be taken over
+ * by the next one at that address, as that starts out with m_logok unset.
+ */
+static thread_local unordered_map<const unc_text *, vector<UINT8> > g_logtext;
+
+
+UINT32 unc_text::intern()
+{
+   if (m_sym != 0)
+   {
+      return(m_sym);
+   }
+
+   int    len = size();
+   UINT32 h   = 2166136261u;
+   for (int idx = 0; idx < len; idx++)
+   {
+      h = (h ^ (UINT32)char_at(idx)) * 16777619u;
+   }
+
+   UINT32 mask = g_syms.slots.size() - 1;
+   UINT32 slot = h & mask;
+   while (g_syms.slots[slot] != 0)
+   {
+      UINT32 sym = g_syms.slots[slot];
+
+      if ((g_syms.hash[sym] == h) &&
+          ((int)(g_syms.start[sym + 1] - g_syms.start[sym]) == len))
+      {
+         const int *text = g_syms.chars.data() + g_syms.start[sym];
+         int       idx   = 0;
+         while ((idx < len) && (text[idx] == char_at(idx)))
+         {
+            idx++;
+         }
+         if (idx == len)
+         {
+            m_sym = sym;
+            return(m_sym);
+         }
+      }
+      slot = (slot + 1) & mask;
+   }
+
+   /* Not there, so add it */
+   m_sym = g_syms.count() + 1;
+   for (int idx = 0; idx < len; idx++)
+   {
+      g_syms.chars.push_back(char_at(idx));
+   }
+   g_syms.start.push_back(g_syms.chars.size());
+   g_syms.hash.push_back(h);
+   g_syms.slots[slot] = m_sym;
+   if (g_syms.count() * 2 > g_syms.slots.size())
+   {
+      g_syms.grow();
+   }
+   return(m_sym);
+}
+
+
+void unc_text::clear_symbols()
+{
+   g_syms.clear();
+}
+
+
+void unc_text::own()
+{
+   if (m_ref != NULL)
+   {
+      m_chars.assign(m_ref, m_ref + m_ref_len);
+      m_ref     = NULL;
+      m_ref_len = 0;
+      m_ref_max = 0;
+   }
+}
+
+void unc_text::clear_logtext()
+{
+   g_logtext.clear();
+}
+
+size_t unc_text::logtext_bytes()
+{
+   size_t total = 0;
+
+   for (unordered_map<const unc_text *, vector<UINT8> >::const_iterator it = g_logtext.begin();
+        it != g_logtext.end(); ++it)
+   {
+      total += sizeof(*it) + it->second.capacity();
+   }
+   return(total);
+}
+
+const char *unc_text::c_str()
 {
-   if (!m_logok)
+   vector<UINT8>& logtext = g_logtext[this];
+
+   /* The entry is empty if it is new or was cleared since it was filled */
+   if (!m_logok || logtext.empty())
    {
-      /* make a pessimistic guess at the size */
-      m_logtext.clear();
-      m_logtext.reserve(m_chars.size() * 3);
-      for (value_type::iterator it = m_chars.begin(); it != m_chars.end(); ++it)
+      int len = size();
+
+      logtext.clear();
+      if (m_ref != NULL)
       {
-         encode_utf8(*it, m_logtext);
+         /* referenced text is plain ASCII, which is already UTF-8 */
+         logtext.assign(m_ref, m_ref + len);
       }
-      m_logtext.push_back(0);
+      else
+      {
+         /* make a pessimistic guess at the size */
+         logtext.reserve(len * 3);
+         for (int idx = 0; idx < len; idx++)
+         {
+            encode_utf8(m_chars[idx], logtext);
+         }
+      }
+      logtext.push_back(0);
       m_logok = true;
    }
+   return((const char *)&logtext[0]);
 }
 
 int unc_text::compare(const unc_text& ref1, const unc_text& ref2, int len)
 {
+   if ((ref1.m_sym != 0) && (ref1.m_sym == ref2.m_sym))
+   {
+      return(0);
+   }
+
    int idx, len1, len2;
    len1 = ref1.size();
    len2 = ref2.size();
@@ -67,9 +244,9 @@ int unc_text::compare(const unc_text& ref1, const unc_text& ref2, int len)
    {
       for (idx = 0; (idx < len1) && (idx < len2) && (idx < len); idx++)
       {
-         if (ref1.m_chars[idx] != ref2.m_chars[idx])
+         if (ref1.char_at(idx) != ref2.char_at(idx))
          {
-            return(ref1.m_chars[idx] - ref2.m_chars[idx]);
+            return(ref1.char_at(idx) - ref2.char_at(idx));
          }
       }
       if (idx == len)
@@ -81,9 +258,9 @@ int unc_text::compare(const unc_text& ref1, const unc_text& ref2, int len)
 
    for (idx = 0; (idx < len1) && (idx < len2); idx++)
    {
-      if (ref1.m_chars[idx] != ref2.m_chars[idx])
+      if (ref1.char_at(idx) != ref2.char_at(idx))
       {
-         return(ref1.m_chars[idx] - ref2.m_chars[idx]);
+         return(ref1.char_at(idx) - ref2.char_at(idx));
       }
    }
    return (len1 - len2);
@@ -91,14 +268,31 @@ int unc_text::compare(const unc_text& ref1, const unc_text& ref2, int len)
 
 bool unc_text::equals(const unc_text& ref) const
 {
+   if ((m_sym != 0) && (ref.m_sym != 0))
+   {
+      return(m_sym == ref.m_sym);
+   }
+
    int len = size();
    if (ref.size() != len)
    {
       return false;
    }
+   if (len == 0)
+   {
+      return true;
+   }
+   if ((m_ref != NULL) && (ref.m_ref != NULL))
+   {
+      return(memcmp(m_ref, ref.m_ref, len) == 0);
+   }
+   if ((m_ref == NULL) && (ref.m_ref == NULL))
+   {
+      return(memcmp(&m_chars[0], &ref.m_chars[0], len * sizeof(int)) == 0);
+   }
    for (int idx = 0; idx < len; idx++)
    {
-      if (m_chars[idx] != ref.m_chars[idx])
+      if (char_at(idx) != ref.char_at(idx))
       {
          return false;
       }
@@ -106,30 +300,77 @@ bool unc_text::equals(const unc_text& ref) const
    return true;
 }
 
-const char *unc_text::c_str()
+bool unc_text::equals(const char *text, int len, bool no_case) const
 {
-   update_logtext();
-   return (const char *)&m_logtext[0];
+   if (size() != len)
+   {
+      return false;
+   }
+   for (int idx = 0; idx < len; idx++)
+   {
+      int ch1 = char_at(idx);
+      int ch2 = (UINT8)text[idx];
+      /* unc_tolower() only looks at the low byte, so keep to ASCII */
+      if (no_case && (ch1 < 0x80) && (ch2 < 0x80))
+      {
+         ch1 = unc_tolower(ch1);
+         ch2 = unc_tolower(ch2);
+      }
+      if (ch1 != ch2)
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+void unc_text::set_ref(const UINT8 *text, int len, int max_len)
+{
+   m_chars.clear();
+   m_ref     = text;
+   m_ref_len = len;
+   m_ref_max = max_len;
+   changed();
 }
 
 void unc_text::set(int ch)
 {
+   m_ref = NULL;
    m_chars.clear();
    m_chars.push_back(ch);
-   m_logok = false;
+   changed();
 }
 
 void unc_text::set(const unc_text& ref)
 {
-   m_chars = ref.m_chars;
-   m_logok = false;
+   if (&ref == this)
+   {
+      return;
+   }
+   if (ref.m_ref != NULL)
+   {
+      set_ref(ref.m_ref, ref.m_ref_len, ref.m_ref_max);
+   }
+   else
+   {
+      m_ref   = NULL;
+      m_chars = ref.m_chars;
+      changed();
+   }
+   m_sym = ref.m_sym;
 }
 
 void unc_text::set(const unc_text& ref, int idx, int len)
 {
    int size = ref.size();
    fix_len_idx(size, idx, len);
-   m_logok = false;
+   if (ref.m_ref != NULL)
+   {
+      set_ref(ref.m_ref + idx, len, ref.m_ref_max - idx);
+      return;
+   }
+   m_ref   = NULL;
+   changed();
    if ((idx == 0) && (len == size))
    {
       m_chars = ref.m_chars;
@@ -149,72 +390,103 @@ void unc_text::set(const string& ascii_text)
 {
    int len = ascii_text.size();
 
+   m_ref = NULL;
    m_chars.resize(len);
    for (int idx = 0; idx < len; idx++)
    {
       m_chars[idx] = ascii_text[idx];
    }
-   m_logok = false;
+   changed();
 }
 
 void unc_text::set(const char *ascii_text)
 {
    int len = strlen(ascii_text);
 
+   m_ref = NULL;
    m_chars.resize(len);
    for (int idx = 0; idx < len; idx++)
    {
       m_chars[idx] = *ascii_text++;
    }
-   m_logok = false;
+   changed();
 }
 
 void unc_text::set(const value_type& data, int idx, int len)
 {
    fix_len_idx(data.size(), idx, len);
+   m_ref = NULL;
    m_chars.resize(len);
    int di = 0;
    while (len-- > 0)
    {
       m_chars[di++] = data[idx++];
    }
-   m_logok = false;
+   changed();
 }
 
 void unc_text::resize(size_t new_size)
 {
    if (size() != (int)new_size)
    {
-      m_chars.resize(new_size);
-      m_logok = false;
+      if ((m_ref != NULL) && ((int)new_size < m_ref_len))
+      {
+         m_ref_len = new_size;
+      }
+      else
+      {
+         own();
+         m_chars.resize(new_size);
+      }
+      changed();
    }
 }
 
 void unc_text::clear()
 {
+   m_ref = NULL;
    m_chars.clear();
-   m_logok = false;
+   changed();
 }
 
 void unc_text::insert(int idx, int ch)
 {
    if (idx >= 0)
    {
+      own();
       m_chars.insert(m_chars.begin() + idx, ch);
-      m_logok = false;
+      changed();
    }
 }
 
 void unc_text::append(int ch)
 {
+   if (m_ref != NULL)
+   {
+      /* Still the same text as the buffer, so keep referring to it.
+       * Only ASCII, as the buffer may hold UTF-8. */
+      if ((ch < 0x80) && (m_ref_len < m_ref_max) && (m_ref[m_ref_len] == ch))
+      {
+         m_ref_len++;
+         changed();
+         return;
+      }
+      own();
+   }
    m_chars.push_back(ch);
-   m_logok = false;
+   changed();
 }
 
 void unc_text::append(const unc_text& ref)
 {
-   m_chars.insert(m_chars.end(), ref.m_chars.begin(), ref.m_chars.end());
-   m_logok = false;
+   int len = ref.size();
+
+   own();
+   for (int idx = 0; idx < len; idx++)
+   {
+      m_chars.push_back(ref.char_at(idx));
+   }
+   changed();
 }
 
 void unc_text::append(const string& ascii_text)
@@ -240,7 +512,7 @@ bool unc_text::startswith(const char *text, int idx) const
    bool match = false;
    while ((idx < size()) && *text)
    {
-      if (*text != m_chars[idx])
+      if (*text != char_at(idx))
       {
          return false;
       }
@@ -257,7 +529,7 @@ bool unc_text::startswith(const unc_text& text, int idx) const
    int  si = 0;
    while ((idx < size()) && (si < text.size()))
    {
-      if (text.m_chars[si] != m_chars[idx])
+      if (text.char_at(si) != char_at(idx))
       {
          return false;
       }
@@ -279,7 +551,7 @@ int unc_text::find(const char *text, int sidx) const
       bool match = true;
       for (ii = 0; ii < len; ii++)
       {
-         if (m_chars[idx + ii] != text[ii])
+         if (char_at(idx + ii) != text[ii])
          {
             match = false;
             break;
@@ -4,6 +4,17 @@
  * At the start of processing, the entire file is decoded into a vector of ints.
  * This class is intended to hold sections of that large vector.
  *
+ * The text may also be a reference to a run of chars in a buffer that
+ * outlives it, such as the plain ASCII input. It is only copied when it is
+ * changed, except for growing it with the chars that follow in the buffer.
+ *
+ * Identifiers are interned by the tokenizer: each distinct text gets a
+ * symbol number, so that two interned texts are equal if their numbers are.
+ * The number is dropped when the text changes.
+ *
+ * The UTF-8 text for logging is only made when c_str() is called and is kept
+ * in a table of the thread, not in the object.
+ *
  * @author  Ben Gardner
  * @license GPL v2+
  */
@@ -12,39 +23,44 @@
 
 #include "base_types.h"
 #include <vector>
-#include <deque>
 #include <string>
+#include <stdexcept>
 using namespace std;
 
 class unc_text
 {
 public:
-   typedef deque<int> value_type;
+   typedef vector<int> value_type;
 
 public:
-   unc_text() : m_logok(false)
+   unc_text() : m_ref(NULL), m_ref_len(0), m_ref_max(0), m_logok(false), m_sym(0)
    {
    }
    ~unc_text()
    {
    }
    unc_text(const unc_text& ref)
+      : m_ref(NULL), m_ref_len(0), m_ref_max(0), m_logok(false), m_sym(0)
    {
       set(ref);
    }
    unc_text(const unc_text& ref, int idx, int len = -1)
+      : m_ref(NULL), m_ref_len(0), m_ref_max(0), m_logok(false), m_sym(0)
    {
       set(ref, idx, len);
    }
    unc_text(const char *ascii_text)
+      : m_ref(NULL), m_ref_len(0), m_ref_max(0), m_logok(false), m_sym(0)
    {
       set(ascii_text);
    }
    unc_text(const string& ascii_text)
+      : m_ref(NULL), m_ref_len(0), m_ref_max(0), m_logok(false), m_sym(0)
    {
       set(ascii_text);
    }
    unc_text(const value_type& data, int idx = 0, int len = -1)
+      : m_ref(NULL), m_ref_len(0), m_ref_max(0), m_logok(false), m_sym(0)
    {
       set(data, idx, len);
    }
@@ -54,9 +70,19 @@ public:
    /* grab the number of characters */
    int size() const
    {
-      return m_chars.size();
+      return((m_ref != NULL) ? m_ref_len : (int)m_chars.size());
    }
 
+   /**
+    * Refers to len chars of text without copying them.
+    * The text must be plain ASCII and stay valid for as long as this refers
+    * to it.
+    *
+    * @param max_len  The number of chars that can be read at text, appending
+    *                 the ones after the first len doesn't copy anything
+    */
+   void set_ref(const UINT8 *text, int len, int max_len);
+
    void set(int ch);
    void set(const unc_text& ref);
    void set(const unc_text& ref, int idx, int len = -1);
@@ -114,9 +140,28 @@ public:
       return(*this);
    }
 
-   /* get the UTF-8 string for logging */
+   /**
+    * Gets the UTF-8 string for logging.
+    * It stays valid until the text is changed or unc_text::clear_logtext()
+    * is called.
+    */
    const char *c_str();
 
+   /**
+    * Drops the logging text of all the unc_text objects of this thread.
+    * No string from c_str() may be in use.
+    */
+   static void clear_logtext();
+
+   /* The memory used for the logging text of this thread */
+   static size_t logtext_bytes();
+
+   /* The number of bytes that the chars use on the heap */
+   size_t heap_bytes() const
+   {
+      return(m_chars.capacity() * sizeof(int));
+   }
+
    operator const char *()
    {
       return c_str();
@@ -125,41 +170,68 @@ public:
    static int compare(const unc_text& ref1, const unc_text& ref2, int len = 0);
    bool equals(const unc_text& ref) const;
 
-   /* grab the data as a series of ints for outputting to a file */
-   value_type& get()
+   /* Compares with len chars of plain ASCII text, maybe ignoring the case */
+   bool equals(const char *text, int len, bool no_case = false) const;
+
+   /**
+    * Looks up the text in the symbol table of this thread, adding it if it
+    * isn't there yet.
+    *
+    * @return the symbol number, which is never 0
+    */
+   UINT32 intern();
+
+   /**
+    * Empties the symbol table of this thread, keeping its memory.
+    * No interned text may be in use.
+    */
+   static void clear_symbols();
+
+   /* The symbol number, 0 if the text isn't interned */
+   UINT32 sym() const
    {
-      m_logok = false;
-      return m_chars;
+      return(m_sym);
    }
 
-   const value_type& get() const
+   /* grab the data as a series of ints for outputting to a file */
+   value_type& get()
    {
+      own();
+      changed();
       return m_chars;
    }
 
    int operator[](int idx) const
    {
-      return(((idx >= 0) && ((size_t)idx < m_chars.size())) ? m_chars[idx] : 0);
+      return(((idx >= 0) && (idx < size())) ? char_at(idx) : 0);
    }
 
    /* throws an exception if out of bounds */
    int& at(int idx)
    {
+      own();
+      changed();
       return m_chars.at(idx);
    }
 
-   const int& at(int idx) const
+   int at(int idx) const
    {
-      return m_chars.at(idx);
+      if ((idx < 0) || (idx >= size()))
+      {
+         throw out_of_range("unc_text::at");
+      }
+      return char_at(idx);
    }
 
-   const int& back() const
+   int back() const
    {
-      return m_chars.back();
+      return char_at(size() - 1);
    }
 
    int& back()
    {
+      own();
+      changed();
       return m_chars.back();
    }
 
@@ -172,8 +244,15 @@ public:
    {
       if (size() > 0)
       {
-         m_chars.pop_back();
-         m_logok = false;
+         if (m_ref != NULL)
+         {
+            m_ref_len--;
+         }
+         else
+         {
+            m_chars.pop_back();
+         }
+         changed();
       }
    }
 
@@ -181,8 +260,17 @@ public:
    {
       if (size() > 0)
       {
-         m_chars.pop_front();
-         m_logok = false;
+         if (m_ref != NULL)
+         {
+            m_ref++;
+            m_ref_len--;
+            m_ref_max--;
+         }
+         else
+         {
+            m_chars.erase(m_chars.begin());
+         }
+         changed();
       }
    }
 
@@ -191,14 +279,35 @@ public:
    int find(const char *text, int idx = 0) const;
 
 protected:
-   void update_logtext();
+   /* The char at idx, which must be less than size() */
+   int char_at(int idx) const
+   {
+      return((m_ref != NULL) ? m_ref[idx] : m_chars[idx]);
+   }
 
-   /* this contains the non-encoded 31-bit chars */
+   /* Copies referenced text into m_chars, before it is changed */
+   void own();
+
+   /* Drops what was worked out from the text */
+   void changed()
+   {
+      m_logok = false;
+      m_sym   = 0;
+   }
+
+   /* this contains the non-encoded 31-bit chars, unless m_ref is set */
    value_type    m_chars;
 
-   /* logging text, utf8 encoded - updated in c_str() */
-   vector<UINT8> m_logtext;
+   /* NULL or the referenced text, see set_ref() */
+   const UINT8   *m_ref;
+   int           m_ref_len;
+   int           m_ref_max;
+
+   /* the logging text from c_str() is up to date */
    bool          m_logok;
+
+   /* 0 or the symbol number, see intern() */
+   UINT32        m_sym;
 };
 
 
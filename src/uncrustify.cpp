@@ -19,11 +19,16 @@
 #include "log_levels.h"
 #include "md5.h"
 #include "backup.h"
+#include "cache.h"
+#include "server.h"
+#include "recurse.h"
+#include "diff.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <ctime>
 #include <fcntl.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -32,39 +37,74 @@
 #ifdef HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 #ifdef HAVE_STRINGS_H
 #include <strings.h>  /* strcasecmp() */
 #endif
 #include <vector>
 #include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* Global data - one formatting context per thread */
+thread_local struct cp_data cpd;
 
-/* Global data */
-struct cp_data cpd;
+/**
+ * The list of files for a multi-file run, shared by the '-j' workers.
+ * With '--recursive' the list grows while the workers are busy.
+ */
+struct source_queue
+{
+   vector<string>       files;
+   size_t               next;       /* index of the next file to process */
+   bool                 walking;    /* more files may be added to files */
+   mutex                lock;       /* protects files, next, walking and error_count */
+   condition_variable   ready;      /* signaled when files or walking change */
+   const vector<string> *folders;   /* the folders to walk */
+   const recurse_filter *filter;
+   const cp_data        *cfg;       /* the configured context of the main thread */
+   const char           *prefix;
+   const char           *suffix;
+   bool                 no_backup;
+   bool                 keep_mtime;
+   bool                 check;
+   bool                 diff;
+   UINT32               error_count; /* errors collected from the workers */
+};
 
 
-static int language_from_tag(const char *tag);
-static int language_from_filename(const char *filename);
-static const char *language_to_string(int lang);
 static bool read_stdin(file_mem& fm);
-static void uncrustify_start(const deque<int>& data);
+static void check_report(const char *filename, bool differs, size_t pos);
+static void check_output(const char *filename, const file_mem& fm,
+                         const vector<UINT8>& out);
+static bool check_file(const char *filename, const file_mem& fm,
+                       const char *parsed_file);
+static void diff_output(const char *filename, const file_mem& fm,
+                        const vector<UINT8>& out);
+static void uncrustify_start(const file_mem& fm);
 static void uncrustify_end();
-static void uncrustify_file(const file_mem& fm, FILE *pfout,
-                            const char *parsed_file);
 static void do_source_file(const char *filename_in,
                            const char *filename_out,
                            const char *parsed_file,
-                           bool no_backup, bool keep_mtime);
-static void process_source_list(const char *source_list, const char *prefix,
-                                const char *suffix, bool no_backup, bool keep_mtime);
-static int load_header_files();
+                           bool no_backup, bool keep_mtime, bool check,
+                           bool diff);
+static void read_source_list(const char *source_list, vector<string>& files);
+static void do_source_files(const vector<string>& files,
+                            const vector<string>& folders,
+                            const recurse_filter& filter,
+                            const char *prefix, const char *suffix,
+                            bool no_backup, bool keep_mtime, bool check,
+                            bool diff, int jobs);
 
 static const char *make_output_filename(char *buf, int buf_size,
                                         const char *filename,
                                         const char *prefix,
                                         const char *suffix);
 
-static int load_mem_file(const char *filename, file_mem& fm);
-
 
 /**
  * Replace the brain-dead and non-portable basename().
@@ -158,10 +198,25 @@ static void usage_exit(const char *msg, const char *argv0, int code)
 #ifdef HAVE_UTIME_H
            " --mtime      : preserve mtime on replaced files\n"
 #endif
+           " --recursive DIR : process the files in DIR and the folders below it. May be repeated\n"
+           " --include GLOB  : with --recursive, only take files that match GLOB. May be repeated\n"
+           " --exclude GLOB  : with --recursive, skip files and folders that match GLOB. May be repeated\n"
+           " --ignore-file FILE : with --recursive, read more exclude globs from FILE\n"
+           " -j N         : process N files in parallel, 0 = one per CPU. Use with -F, --recursive or files\n"
+           " --cache DIR  : remember results in DIR and skip files that were done before\n"
+           " --check      : don't write anything, print PASS/FAIL for each file and fail\n"
+           "                if any file would change\n"
+           " --diff       : don't write anything, print a unified diff for each file that\n"
+           "                would change\n"
+           " --lines S-E  : only format the statements and functions on input lines S to E\n"
+           "                and print them after '@@ FIRST-LAST @@', the input lines they\n"
+           "                replace. May be repeated\n"
            " -l           : language override: C, CPP, D, CS, JAVA, PAWN, OC, OC+\n"
            " -t           : load a file with types (usually not needed)\n"
            " -q           : quiet mode - no output on stderr (-L will override)\n"
            " --frag       : code fragment, assume the first line is indented correctly\n"
+           " --server     : load the config once and format requests from stdin, see server.h\n"
+           " --socket PATH: use with --server to listen on a Unix domain socket instead\n"
            "\n"
            "Config/Help Options:\n"
            " -h -? --help --usage     : print this message and exit\n"
@@ -188,6 +243,7 @@ static void usage_exit(const char *msg, const char *argv0, int code)
            "uncrustify -c my.cfg --replace foo.d\n"
            "uncrustify -c my.cfg --no-backup foo.d\n"
            "uncrustify -c my.cfg --prefix=out -F files.txt\n"
+           "uncrustify -c my.cfg --no-backup -j 8 -F files.txt\n"
            "\n"
            "Note: Use comments containing ' *INDENT-OFF*' and ' *INDENT-ON*' to disable\n"
            "      processing of parts of the source file.\n"
@@ -227,16 +283,23 @@ static void redir_stdout(const char *output_file)
 }
 
 
-int main(int argc, char *argv[])
+/**
+ * The command line tool. main() lives in main.cpp so that the rest of the
+ * code can be built into libuncrustify.
+ */
+int uncrustify_main(int argc, char *argv[])
 {
-   string     cfg_file;
-   const char *parsed_file = NULL;
-   const char *source_file = NULL;
-   const char *output_file = NULL;
-   const char *source_list = NULL;
-   log_mask_t mask;
-   int        idx;
-   const char *p_arg;
+   string         cfg_file;
+   const char     *parsed_file = NULL;
+   const char     *source_file = NULL;
+   const char     *output_file = NULL;
+   const char     *source_list = NULL;
+   int            jobs         = 1;
+   vector<string> folders;
+   recurse_filter filter;
+   log_mask_t     mask;
+   int            idx;
+   const char     *p_arg;
 
    /* If ran without options... check keyword sort and show the usage info */
    if (argc == 1)
@@ -399,8 +462,10 @@ int main(int argc, char *argv[])
       // not using a file list, source_list is NULL
    }
 
-   const char *prefix = arg.Param("--prefix");
-   const char *suffix = arg.Param("--suffix");
+   const char *prefix      = arg.Param("--prefix");
+   const char *suffix      = arg.Param("--suffix");
+   const char *socket_path = arg.Param("--socket");
+   const char *cache_dir   = arg.Param("--cache");
 
    bool no_backup        = arg.Present("--no-backup");
    bool replace          = arg.Present("--replace");
@@ -408,6 +473,60 @@ int main(int argc, char *argv[])
    bool update_config    = arg.Present("--update-config");
    bool update_config_wd = arg.Present("--update-config-with-doc");
    bool detect           = arg.Present("--detect");
+   bool server           = arg.Present("--server");
+   bool check            = arg.Present("--check");
+   bool diff             = arg.Present("--diff");
+
+   /* Get the input lines to change, if not all of them */
+   idx = 0;
+   while ((p_arg = arg.Params("--lines", idx)) != NULL)
+   {
+      line_range lr;
+      char       extra;
+
+      if ((sscanf(p_arg, "%d-%d%c", &lr.first, &lr.last, &extra) != 2) ||
+          (lr.first < 1) || (lr.last < lr.first))
+      {
+         usage_exit("The --lines option expects START-END, like 10-20", argv[0], 70);
+      }
+      cpd.lines.push_back(lr);
+   }
+
+   /* Get the folders to walk and what to take from them */
+   idx = 0;
+   while ((p_arg = arg.Params("--recursive", idx)) != NULL)
+   {
+      folders.push_back(p_arg);
+   }
+   idx = 0;
+   while ((p_arg = arg.Params("--include", idx)) != NULL)
+   {
+      filter.include.push_back(p_arg);
+   }
+   idx = 0;
+   while ((p_arg = arg.Params("--exclude", idx)) != NULL)
+   {
+      filter.exclude.push_back(p_arg);
+   }
+   idx = 0;
+   while ((p_arg = arg.Params("--ignore-file", idx)) != NULL)
+   {
+      if (!recurse_load_ignore_file(p_arg, filter))
+      {
+         usage_exit("Unable to load the ignore file", argv[0], 71);
+      }
+   }
+
+   /* Get the number of parallel jobs */
+   if (((p_arg = arg.Param("--jobs")) != NULL) ||
+       ((p_arg = arg.Param("-j")) != NULL))
+   {
+      jobs = atoi(p_arg);
+      if (jobs <= 0)
+      {
+         jobs = thread::hardware_concurrency();
+      }
+   }
 
    /* Grab the output override */
    output_file = arg.Param("-o");
@@ -421,6 +540,36 @@ int main(int argc, char *argv[])
    LOG_FMT(LDATA, "replace     = %d\n", replace);
    LOG_FMT(LDATA, "no_backup   = %d\n", no_backup);
    LOG_FMT(LDATA, "detect      = %d\n", detect);
+   LOG_FMT(LDATA, "check       = %d\n", check);
+   LOG_FMT(LDATA, "diff        = %d\n", diff);
+   LOG_FMT(LDATA, "jobs        = %d\n", jobs);
+   LOG_FMT(LDATA, "cache_dir   = %s\n", (cache_dir != NULL) ? cache_dir : "null");
+   for (idx = 0; idx < (int)cpd.lines.size(); idx++)
+   {
+      LOG_FMT(LDATA, "lines       = %d-%d\n", cpd.lines[idx].first, cpd.lines[idx].last);
+   }
+   for (idx = 0; idx < (int)folders.size(); idx++)
+   {
+      LOG_FMT(LDATA, "recursive   = %s\n", folders[idx].c_str());
+   }
+   for (idx = 0; idx < (int)filter.include.size(); idx++)
+   {
+      LOG_FMT(LDATA, "include     = %s\n", filter.include[idx].c_str());
+   }
+   for (idx = 0; idx < (int)filter.exclude.size(); idx++)
+   {
+      LOG_FMT(LDATA, "exclude     = %s\n", filter.exclude[idx].c_str());
+   }
+
+   if (diff && (check || replace || no_backup))
+   {
+      usage_exit("Cannot use --diff with --check, --replace or --no-backup", argv[0], 72);
+   }
+
+   if (!cpd.lines.empty() && (check || diff || replace || no_backup))
+   {
+      usage_exit("Cannot use --lines with --check, --diff, --replace or --no-backup", argv[0], 73);
+   }
 
    if (replace || no_backup)
    {
@@ -498,7 +647,7 @@ int main(int argc, char *argv[])
          return(EXIT_FAILURE);
       }
 
-      uncrustify_start(fm.data);
+      uncrustify_start(fm);
       detect_options();
       uncrustify_end();
 
@@ -532,7 +681,7 @@ int main(int argc, char *argv[])
    p_arg = arg.Unused(idx);
 
    /* Check args - for multifile options */
-   if ((source_list != NULL) || (p_arg != NULL))
+   if ((source_list != NULL) || !folders.empty() || (p_arg != NULL))
    {
       if (source_file != NULL)
       {
@@ -550,7 +699,23 @@ int main(int argc, char *argv[])
    /* This relies on cpd.filename being the config file name */
    load_header_files();
 
-   if ((source_file == NULL) && (source_list == NULL) && (p_arg == NULL))
+   if (cache_dir != NULL)
+   {
+      cache_init(cache_dir);
+   }
+
+   if (server)
+   {
+      if ((source_file != NULL) || (source_list != NULL) || !folders.empty() ||
+          (p_arg != NULL))
+      {
+         usage_exit("Cannot use --server with input files.", argv[0], 69);
+      }
+      return(server_main(socket_path));
+   }
+
+   if ((source_file == NULL) && (source_list == NULL) && folders.empty() &&
+       (p_arg == NULL))
    {
       /* no input specified, so use stdin */
       if (cpd.lang_flags == 0)
@@ -571,15 +736,36 @@ int main(int argc, char *argv[])
 
       /* Done reading from stdin */
       LOG_FMT(LSYS, "Parsing: %d bytes (%d chars) from stdin as language %s\n",
-              (int)fm.raw.size(), (int)fm.data.size(),
+              (int)fm.size(), (int)fm.length(),
               language_to_string(cpd.lang_flags));
 
-      uncrustify_file(fm, stdout, parsed_file);
+      if (check)
+      {
+         check_file(cpd.filename, fm, parsed_file);
+      }
+      else if (diff)
+      {
+         vector<UINT8> out;
+
+         uncrustify_file(fm, &out, parsed_file);
+         diff_output(cpd.filename, fm, out);
+      }
+      else
+      {
+         uncrustify_file(fm, stdout, parsed_file);
+      }
    }
    else if (source_file != NULL)
    {
       /* Doing a single file */
-      do_source_file(source_file, output_file, parsed_file, no_backup, keep_mtime);
+      if (diff)
+      {
+         /* The diff goes to stdout, which may be redirected */
+         redir_stdout(output_file);
+         output_file = NULL;
+      }
+      do_source_file(source_file, output_file, parsed_file, no_backup,
+                     keep_mtime, check, diff);
    }
    else
    {
@@ -594,19 +780,21 @@ int main(int argc, char *argv[])
       }
 
       /* Do the files on the command line first */
+      vector<string> files;
+
       idx = 1;
       while ((p_arg = arg.Unused(idx)) != NULL)
       {
-         char outbuf[1024];
-         do_source_file(p_arg,
-                        make_output_filename(outbuf, sizeof(outbuf), p_arg, prefix, suffix),
-                        NULL, no_backup, keep_mtime);
+         files.push_back(p_arg);
       }
 
       if (source_list != NULL)
       {
-         process_source_list(source_list, prefix, suffix, no_backup, keep_mtime);
+         read_source_list(source_list, files);
       }
+
+      do_source_files(files, folders, filter, prefix, suffix, no_backup,
+                      keep_mtime, check, diff, jobs);
    }
 
    clear_keyword_file();
@@ -616,9 +804,13 @@ int main(int argc, char *argv[])
 }
 
 
-static void process_source_list(const char *source_list,
-                                const char *prefix, const char *suffix,
-                                bool no_backup, bool keep_mtime)
+/**
+ * Reads the list of files to process and appends them to files.
+ *
+ * @param source_list  The file with one filename per line
+ * @param files        The list to add the filenames to
+ */
+static void read_source_list(const char *source_list, vector<string>& files)
 {
    FILE *p_file = fopen(source_list, "r");
 
@@ -662,16 +854,186 @@ static void process_source_list(const char *source_list,
 
       if (fname[0] != '#')
       {
-         char outbuf[1024];
-         do_source_file(fname,
-                        make_output_filename(outbuf, sizeof(outbuf), fname, prefix, suffix),
-                        NULL, no_backup, keep_mtime);
+         files.push_back(fname);
       }
    }
    fclose(p_file);
 }
 
 
+/**
+ * Processes files from the queue until it is empty.
+ * Runs in the main thread or in one of the '-j' workers.
+ */
+static void do_source_queue(source_queue& sq)
+{
+   while (true)
+   {
+      string fname;
+
+      {
+         unique_lock<mutex> guard(sq.lock);
+
+         /* Wait for the walker if it hasn't found the next file yet */
+         while ((sq.next >= sq.files.size()) && sq.walking)
+         {
+            sq.ready.wait(guard);
+         }
+         if (sq.next >= sq.files.size())
+         {
+            break;
+         }
+         /* Copy the name, files may be reallocated by the walker */
+         fname = sq.files[sq.next++];
+      }
+
+      char outbuf[1024];
+      do_source_file(fname.c_str(),
+                     make_output_filename(outbuf, sizeof(outbuf), fname.c_str(),
+                                          sq.prefix, sq.suffix),
+                     NULL, sq.no_backup, sq.keep_mtime, sq.check, sq.diff);
+   }
+}
+
+
+/**
+ * Entry point for a '-j' worker thread.
+ * The thread gets a copy of the configured context and then competes with
+ * the other workers for the files in the queue.
+ */
+static void source_worker(source_queue *sq)
+{
+   cpd             = *sq->cfg;
+   cpd.error_count = 0;
+
+   do_source_queue(*sq);
+
+   sq->lock.lock();
+   sq->error_count += cpd.error_count;
+   sq->lock.unlock();
+}
+
+
+/**
+ * Called by recurse_folder() for each file that is found.
+ * Adds the file to the queue and wakes up a worker.
+ */
+static void source_found(const string& path, void *arg)
+{
+   source_queue *sq = (source_queue *)arg;
+
+   sq->lock.lock();
+   sq->files.push_back(path);
+   sq->lock.unlock();
+   sq->ready.notify_one();
+}
+
+
+/**
+ * Entry point for the thread that walks the '--recursive' folders.
+ * The workers start on the files as soon as they are found.
+ */
+static void source_walker(source_queue *sq)
+{
+   UINT32 errors = 0;
+
+   for (size_t idx = 0; idx < sq->folders->size(); idx++)
+   {
+      errors += recurse_folder((*sq->folders)[idx].c_str(), *sq->filter,
+                               source_found, sq);
+   }
+
+   sq->lock.lock();
+   sq->walking      = false;
+   sq->error_count += errors;
+   LOG_FMT(LNOTE, "Found %d files\n", (int)sq->files.size());
+   sq->lock.unlock();
+   sq->ready.notify_all();
+}
+
+
+/**
+ * Processes a list of files, using up to 'jobs' threads.
+ * The folders are walked in another thread while the files are processed.
+ *
+ * @param files      The files to process
+ * @param folders    The folders to walk for more files
+ * @param filter     Which files to take from the folders
+ * @param prefix     NULL or the output prefix
+ * @param suffix     NULL or the output suffix
+ * @param no_backup  don't create a backup when replacing a file
+ * @param keep_mtime don't change the mtime (dangerous)
+ * @param check      only check the files, write nothing
+ * @param diff       only print a diff for each file, write nothing
+ * @param jobs       The number of files to process in parallel
+ */
+static void do_source_files(const vector<string>& files,
+                            const vector<string>& folders,
+                            const recurse_filter& filter,
+                            const char *prefix, const char *suffix,
+                            bool no_backup, bool keep_mtime, bool check,
+                            bool diff, int jobs)
+{
+   source_queue sq;
+
+   sq.files       = files;
+   sq.next        = 0;
+   sq.walking     = !folders.empty();
+   sq.folders     = &folders;
+   sq.filter      = &filter;
+   sq.cfg         = &cpd;
+   sq.prefix      = prefix;
+   sq.suffix      = suffix;
+   sq.no_backup   = no_backup;
+   sq.keep_mtime  = keep_mtime;
+   sq.check       = check;
+   sq.diff        = diff;
+   sq.error_count = 0;
+
+   thread walker;
+   if (sq.walking)
+   {
+      walker = thread(source_walker, &sq);
+   }
+   else if (jobs > (int)files.size())
+   {
+      jobs = files.size();
+   }
+
+   if (jobs <= 1)
+   {
+      do_source_queue(sq);
+   }
+   else
+   {
+      if (sq.walking)
+      {
+         LOG_FMT(LNOTE, "Processing the files found with %d jobs\n", jobs);
+      }
+      else
+      {
+         LOG_FMT(LNOTE, "Processing %d files with %d jobs\n", (int)files.size(), jobs);
+      }
+
+      vector<thread> workers;
+      for (int idx = 0; idx < jobs; idx++)
+      {
+         workers.push_back(thread(source_worker, &sq));
+      }
+      for (int idx = 0; idx < jobs; idx++)
+      {
+         workers[idx].join();
+      }
+   }
+
+   if (walker.joinable())
+   {
+      walker.join();
+   }
+   cpd.error_count += sq.error_count;
+}
+
+
 static bool read_stdin(file_mem& fm)
 {
    deque<UINT8> dq;
@@ -679,9 +1041,7 @@ static bool read_stdin(file_mem& fm)
    int          len;
    int          idx;
 
-   fm.raw.clear();
-   fm.data.clear();
-   fm.enc = ENC_ASCII;
+   fm = file_mem();
 
    while (!feof(stdin))
    {
@@ -694,11 +1054,11 @@ static bool read_stdin(file_mem& fm)
 
    /* Copy the raw data from the deque to the vector */
    fm.raw.insert(fm.raw.end(), dq.begin(), dq.end());
-   return(decode_unicode(fm.raw, fm.data, fm.enc, fm.bom));
+   return(decode_file(fm));
 }
 
 
-static void make_folders(const string& filename)
+void make_folders(const string& filename)
 {
    int  idx;
    int  last_idx = 0;
@@ -734,18 +1094,49 @@ static void make_folders(const string& filename)
 }
 
 
+#ifdef HAVE_SYS_MMAN_H
+/**
+ * Maps a file into fm.map.
+ * The mapping is private and read-only and is dropped with the last copy of
+ * the file_mem.
+ *
+ * @return false if the file can't be mapped and needs to be read instead
+ */
+static bool map_mem_file(FILE *p_file, size_t len, file_mem& fm)
+{
+   void *ptr = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fileno(p_file), 0);
+
+   if (ptr == MAP_FAILED)
+   {
+      return(false);
+   }
+#ifdef MADV_SEQUENTIAL
+   /* The tokenizer makes a single pass from start to end */
+   (void)madvise(ptr, len, MADV_SEQUENTIAL);
+#endif
+
+   fm.map.reset((const UINT8 *)ptr, [len](const UINT8 *p)
+   {
+      munmap((void *)p, len);
+   });
+   fm.map_len = len;
+   return(true);
+}
+#endif
+
+
 /**
- * Loads a file into memory
+ * Loads a file into memory.
+ * The file is mapped where that is supported, so that plain ASCII text is
+ * never copied. Other encodings are decoded into fm.data.
  */
-static int load_mem_file(const char *filename, file_mem& fm)
+int load_mem_file(const char *filename, file_mem& fm)
 {
    int         retval = -1;
    struct stat my_stat;
    FILE        *p_file;
 
-   fm.raw.clear();
-   fm.data.clear();
-   fm.enc = ENC_ASCII;
+   fm = file_mem();
 
    /* Grab the stat info for the file */
    if (stat(filename, &my_stat) < 0)
@@ -765,25 +1156,33 @@ static int load_mem_file(const char *filename, file_mem& fm)
       return(-1);
    }
 
-   fm.raw.resize(my_stat.st_size);
    if (my_stat.st_size == 0)
    {
       /* Empty file */
-      retval = 0;
-      fm.bom = false;
-      fm.enc = ENC_ASCII;
-      fm.data.clear();
+      retval   = 0;
+      fm.ascii = true;
    }
    else
    {
-      /* read the raw data */
-      if (fread(&fm.raw[0], fm.raw.size(), 1, p_file) != 1)
+      bool loaded = false;
+
+#ifdef HAVE_SYS_MMAN_H
+      loaded = map_mem_file(p_file, my_stat.st_size, fm);
+#endif
+      if (!loaded)
+      {
+         /* read the raw data */
+         fm.raw.resize(my_stat.st_size);
+         loaded = (fread(&fm.raw[0], fm.raw.size(), 1, p_file) == 1);
+      }
+
+      if (!loaded)
       {
          LOG_FMT(LERR, "%s: fread(%s) failed: %s (%d)\n",
                  __func__, filename, strerror(errno), errno);
          cpd.error_count++;
       }
-      else if (!decode_unicode(fm.raw, fm.data, fm.enc, fm.bom))
+      else if (!decode_file(fm))
       {
          LOG_FMT(LERR, "%s: failed to decode the file '%s'\n", __func__, filename);
       }
@@ -823,7 +1222,7 @@ static int load_mem_file_config(const char *filename, file_mem& fm)
 }
 
 
-static int load_header_files()
+int load_header_files()
 {
    int retval = 0;
 
@@ -880,76 +1279,98 @@ static const char *make_output_filename(char *buf, int buf_size,
 }
 
 
-/**
- * Reinvent the wheel with a file comparision function...
- */
-static bool file_content_matches(const string& filename1, const string& filename2)
+const char *fix_filename(const char *filename)
 {
-   struct stat st1, st2;
-   int         fd1, fd2;
-   UINT8       buf1[1024], buf2[1024];
-   int         len1 = 0, len2 = 0;
-   int         minlen;
+   char *tmp_file;
 
-   /* Check the sizes first */
-   if ((stat(filename1.c_str(), &st1) != 0) ||
-       (stat(filename2.c_str(), &st2) != 0) ||
-       (st1.st_size != st2.st_size))
+   /* Create 'outfile.uncrustify' */
+   tmp_file = new char[strlen(filename) + 16 + 1]; /* + 1 for '\0' */
+   if (tmp_file != NULL)
    {
-      return(false);
+      sprintf(tmp_file, "%s.uncrustify", filename);
    }
+   return(tmp_file);
+}
+
 
-   if ((fd1 = open(filename1.c_str(), O_RDONLY)) < 0)
+/**
+ * Prints the result of '--check' for a file.
+ * A file that would change counts as an error.
+ *
+ * @param differs  whether the output differs from the input
+ * @param pos      the offset of the first difference or the size of the file
+ */
+static void check_report(const char *filename, bool differs, size_t pos)
+{
+   if (differs)
    {
-      return(false);
+      printf("FAIL: %s (Difference at byte %lu)\n", filename, (unsigned long)pos);
+      cpd.error_count++;
    }
-   if ((fd2 = open(filename2.c_str(), O_RDONLY)) < 0)
+   else
    {
-      close(fd1);
-      return(false);
+      printf("PASS: %s (%lu bytes)\n", filename, (unsigned long)pos);
    }
+}
 
-   while ((len1 >= 0) && (len2 >= 0))
+
+/**
+ * Reports whether the formatted output differs from the input, for '--check'.
+ */
+static void check_output(const char *filename, const file_mem& fm,
+                         const vector<UINT8>& out)
+{
+   const UINT8 *in = fm.bytes();
+   size_t      idx;
+
+   for (idx = 0; (idx < fm.size()) && (idx < out.size()); idx++)
    {
-      if (len1 == 0)
-      {
-         len1 = read(fd1, buf1, sizeof(buf1));
-      }
-      if (len2 == 0)
-      {
-         len2 = read(fd2, buf2, sizeof(buf2));
-      }
-      if ((len1 <= 0) || (len2 <= 0))
+      if (in[idx] != out[idx])
       {
          break;
       }
-      minlen = (len1 < len2) ? len1 : len2;
-      if (memcmp(buf1, buf2, minlen) != 0)
-      {
-         break;
-      }
-      len1 -= minlen;
-      len2 -= minlen;
    }
+   check_report(filename, (idx != fm.size()) || (idx != out.size()), idx);
+}
+
+
+/**
+ * Formats a file and compares the output with the input while it is
+ * rendered, for '--check'. The output is not kept and rendering stops at the
+ * first difference, so only a file that passes costs a full render.
+ *
+ * @return true if the output is the same as the input
+ */
+static bool check_file(const char *filename, const file_mem& fm,
+                       const char *parsed_file)
+{
+   vector<UINT8> scratch;
 
-   close(fd1);
-   close(fd2);
+   cpd.out_cmp = &fm;
+   uncrustify_file(fm, &scratch, parsed_file);
+   cpd.out_cmp = NULL;
 
-   return((len1 == 0) && (len2 == 0));
+   check_report(filename, cpd.out_differs, cpd.out_cmp_pos);
+   return(!cpd.out_differs);
 }
 
 
-const char *fix_filename(const char *filename)
+/**
+ * Prints a unified diff from the input to the output, for '--diff'.
+ * The diff is written in one go, so that the diffs from the '-j' workers
+ * don't get mixed up.
+ */
+static void diff_output(const char *filename, const file_mem& fm,
+                        const vector<UINT8>& out)
 {
-   char *tmp_file;
+   vector<UINT8> text;
 
-   /* Create 'outfile.uncrustify' */
-   tmp_file = new char[strlen(filename) + 16 + 1]; /* + 1 for '\0' */
-   if (tmp_file != NULL)
+   diff_unified(filename, fm.bytes(), fm.size(),
+                (out.size() > 0) ? &out[0] : NULL, out.size(), text);
+   if (text.size() > 0)
    {
-      sprintf(tmp_file, "%s.uncrustify", filename);
+      fwrite(&text[0], text.size(), 1, stdout);
    }
-   return(tmp_file);
 }
 
 
@@ -961,12 +1382,16 @@ const char *fix_filename(const char *filename)
  * @param parsed_file  NULL or the filename for the parsed debug info
  * @param no_backup    don't create a backup, if filename_out == filename_in
  * @param keep_mtime   don't change the mtime (dangerous)
+ * @param check        only compare the output with the input, write nothing
+ * @param diff         only print a diff to stdout, write nothing
  */
 static void do_source_file(const char *filename_in,
                            const char *filename_out,
                            const char *parsed_file,
                            bool       no_backup,
-                           bool       keep_mtime)
+                           bool       keep_mtime,
+                           bool       check,
+                           bool       diff)
 {
    FILE     *pfout;
    bool     did_open    = false;
@@ -988,8 +1413,61 @@ static void do_source_file(const char *filename_in,
       return;
    }
 
-   LOG_FMT(LSYS, "Parsing: %s as language %s\n",
-           filename_in, language_to_string(cpd.lang_flags));
+   /* Render to memory, so that the result can be compared with the input */
+   vector<UINT8> out;
+   cache_result  hit = cache_lookup(filename_in, fm, out);
+
+   cpd.filename = filename_in;
+   if (hit == CACHE_MISS)
+   {
+      UINT32 errors = cpd.error_count;
+
+      LOG_FMT(LSYS, "Parsing: %s as language %s\n",
+              filename_in, language_to_string(cpd.lang_flags));
+
+      if (check)
+      {
+         /* Only a clean result is known in full, so only that is stored */
+         if (check_file(filename_in, fm, parsed_file) &&
+             (cpd.error_count == errors))
+         {
+            cache_store(filename_in, fm, NULL);
+         }
+         return;
+      }
+
+      /* uncrustify_file() appends, so start from nothing */
+      out.clear();
+      uncrustify_file(fm, &out, parsed_file);
+      if (cpd.error_count == errors)
+      {
+         cache_store(filename_in, fm, &out);
+      }
+   }
+
+   bool clean = (hit == CACHE_CLEAN) || fm.same_as(out);
+
+   if (check)
+   {
+      if (clean)
+      {
+         check_report(filename_in, false, fm.size());
+      }
+      else
+      {
+         check_output(filename_in, fm, out);
+      }
+      return;
+   }
+
+   if (diff)
+   {
+      if (!clean)
+      {
+         diff_output(filename_in, fm, out);
+      }
+      return;
+   }
 
    if (filename_out == NULL)
    {
@@ -1001,12 +1479,18 @@ static void do_source_file(const char *filename_in,
       filename_tmp = filename_out;
       if (strcmp(filename_in, filename_out) == 0)
       {
+         /* No change - leave the file alone */
+         if (clean)
+         {
+            return;
+         }
+
          /* Create 'outfile.uncrustify' */
          filename_tmp = fix_filename(filename_out);
 
          if (!no_backup)
          {
-            if (backup_copy_file(filename_in, fm.raw) != SUCCESS)
+            if (backup_copy_file(filename_in, fm.bytes(), fm.size()) != SUCCESS)
             {
                LOG_FMT(LERR, "%s: Failed to create backup file for %s\n",
                        __func__, filename_in);
@@ -1030,8 +1514,17 @@ static void do_source_file(const char *filename_in,
       //LOG_FMT(LSYS, "Output file %s\n", filename_out);
    }
 
-   cpd.filename = filename_in;
-   uncrustify_file(fm, pfout, parsed_file);
+   if (clean)
+   {
+      if (fm.size() > 0)
+      {
+         fwrite(fm.bytes(), fm.size(), 1, pfout);
+      }
+   }
+   else if (out.size() > 0)
+   {
+      fwrite(&out[0], out.size(), 1, pfout);
+   }
 
    if (did_open)
    {
@@ -1044,29 +1537,20 @@ static void do_source_file(const char *filename_in,
 
       if (filename_tmp != filename_out)
       {
-         /* We need to compare and then do a rename */
-         if (file_content_matches(filename_tmp, filename_out))
-         {
-            /* No change - remove tmp file */
-            (void)unlink(filename_tmp.c_str());
-         }
-         else
-         {
 #ifdef WIN32
 
-            /* windows can't rename a file if the target exists, so delete it
-             * first. This may cause data loss if the tmp file gets deleted
-             * or can't be renamed.
-             */
-            (void)unlink(filename_out);
+         /* windows can't rename a file if the target exists, so delete it
+          * first. This may cause data loss if the tmp file gets deleted
+          * or can't be renamed.
+          */
+         (void)unlink(filename_out);
 #endif
-            /* Change - rename filename_tmp to filename_out */
-            if (rename(filename_tmp.c_str(), filename_out) != 0)
-            {
-               LOG_FMT(LERR, "%s: Unable to rename '%s' to '%s'\n",
-                       __func__, filename_tmp.c_str(), filename_out);
-               cpd.error_count++;
-            }
+         /* Change - rename filename_tmp to filename_out */
+         if (rename(filename_tmp.c_str(), filename_out) != 0)
+         {
+            LOG_FMT(LERR, "%s: Unable to rename '%s' to '%s'\n",
+                    __func__, filename_tmp.c_str(), filename_out);
+            cpd.error_count++;
          }
       }
 
@@ -1087,7 +1571,7 @@ static void add_file_header()
    if (!chunk_is_comment(chunk_get_head()))
    {
       /*TODO: detect the typical #ifndef FOO / #define FOO sequence */
-      tokenize(cpd.file_hdr.data, chunk_get_head());
+      tokenize(cpd.file_hdr, chunk_get_head());
    }
 }
 
@@ -1110,7 +1594,7 @@ static void add_file_footer()
          LOG_FMT(LSYS, "Adding a newline at the end of the file\n");
          newline_add_after(pc);
       }
-      tokenize(cpd.file_ftr.data, NULL);
+      tokenize(cpd.file_ftr, NULL);
    }
 }
 
@@ -1185,11 +1669,12 @@ static void add_func_header(c_token_t type, file_mem& fm)
       {
          /* Insert between after and ref */
          chunk_t *after = chunk_get_next_ncnl(ref);
-         tokenize(fm.data, after);
+         tokenize(fm, after);
          for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
          {
             tmp->level = after->level;
          }
+         chunk_match_changed();
       }
    }
 }
@@ -1285,22 +1770,23 @@ static void add_msg_header(c_token_t type, file_mem& fm)
       {
          /* Insert between after and ref */
          chunk_t *after = chunk_get_next_ncnl(ref);
-         tokenize(fm.data, after);
+         tokenize(fm, after);
          for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
          {
             tmp->level = after->level;
          }
+         chunk_match_changed();
       }
    }
 }
 
 
-static void uncrustify_start(const deque<int>& data)
+static void uncrustify_start(const file_mem& fm)
 {
    /**
     * Parse the text into chunks
     */
-   tokenize(data, NULL);
+   tokenize(fm, NULL);
 
    /* Get the column for the fragment indent */
    if (cpd.frag)
@@ -1311,13 +1797,13 @@ static void uncrustify_start(const deque<int>& data)
    }
 
    /* Add the file header */
-   if (cpd.file_hdr.data.size() > 0)
+   if (cpd.file_hdr.length() > 0)
    {
       add_file_header();
    }
 
    /* Add the file footer */
-   if (cpd.file_ftr.data.size() > 0)
+   if (cpd.file_ftr.length() > 0)
    {
       add_file_footer();
    }
@@ -1339,6 +1825,7 @@ static void uncrustify_start(const deque<int>& data)
    /**
     * At this point, the level information is available and accurate.
     */
+   chunk_match_brackets();
 
    if ((cpd.lang_flags & LANG_PAWN) != 0)
    {
@@ -1359,10 +1846,36 @@ static void uncrustify_start(const deque<int>& data)
 }
 
 
-static void uncrustify_file(const file_mem& fm, FILE *pfout,
-                            const char *parsed_file)
+/**
+ * Formats the file and writes the result to pfout.
+ * If pfout is NULL, then the file is only parsed.
+ */
+void uncrustify_file(const file_mem& fm, FILE *pfout,
+                     const char *parsed_file)
 {
-   const deque<int>& data = fm.data;
+   if (pfout == NULL)
+   {
+      uncrustify_file(fm, (vector<UINT8> *)NULL, parsed_file);
+      return;
+   }
+
+   vector<UINT8> out;
+   uncrustify_file(fm, &out, parsed_file);
+   if (out.size() > 0)
+   {
+      fwrite(&out[0], out.size(), 1, pfout);
+   }
+}
+
+
+/**
+ * Formats the file and appends the result to the out buffer.
+ * If out is NULL, then the file is only parsed.
+ */
+void uncrustify_file(const file_mem& fm, vector<UINT8> *out,
+                     const char *parsed_file)
+{
+   const vector<int>& data = fm.data;
 
    /* Save off the encoding and whether a BOM is required */
    cpd.bom = fm.bom;
@@ -1397,7 +1910,9 @@ static void uncrustify_file(const file_mem& fm, FILE *pfout,
       cpd.bom = true;
    }
 
-   /* Check for embedded 0's (represents a decoding failure or corrupt file) */
+   /* Check for embedded 0's (represents a decoding failure or corrupt file)
+    * Plain ASCII text never has any and is not decoded into data.
+    */
    for (int idx = 0; idx < (int)data.size() - 1; idx++)
    {
       if (data[idx] == 0)
@@ -1410,26 +1925,32 @@ static void uncrustify_file(const file_mem& fm, FILE *pfout,
       }
    }
 
-   uncrustify_start(data);
+   uncrustify_start(fm);
 
    /**
     * Done with detection. Do the rest only if the file will go somewhere.
     * The detection code needs as few changes as possible.
     */
-   if (pfout != NULL)
+   if (out != NULL)
    {
+      /* Only format the regions that hold the '--lines' ranges */
+      if (!cpd.lines.empty())
+      {
+         lines_select();
+      }
+
       /**
        * Add comments before function defs and classes
        */
-      if (cpd.func_hdr.data.size() > 0)
+      if (cpd.func_hdr.length() > 0)
       {
          add_func_header(CT_FUNC_DEF, cpd.func_hdr);
       }
-      if (cpd.class_hdr.data.size() > 0)
+      if (cpd.class_hdr.length() > 0)
       {
          add_func_header(CT_CLASS, cpd.class_hdr);
       }
-      if (cpd.oc_msg_hdr.data.size() > 0)
+      if (cpd.oc_msg_hdr.length() > 0)
       {
          add_msg_header(CT_OC_MSG_DECL, cpd.oc_msg_hdr);
       }
@@ -1609,9 +2130,15 @@ static void uncrustify_file(const file_mem& fm, FILE *pfout,
       }
 
       /**
-       * Now render it all to the output file
+       * Now render it all to the output file.
+       * The output is about the size of the input, so make room for that up
+       * front. A compare only ever holds a few bytes.
        */
-      output_text(pfout);
+      if (cpd.out_cmp == NULL)
+      {
+         out->reserve(out->size() + fm.size() + fm.size() / 8);
+      }
+      output_text(*out);
    }
 
    /* Special hook for dumping parsed data for debugging */
@@ -1636,13 +2163,13 @@ static void uncrustify_file(const file_mem& fm, FILE *pfout,
 
 static void uncrustify_end()
 {
-   /* Free all the memory */
-   chunk_t *pc;
+   /* Free all the chunks, their memory is kept for the next file */
+   chunk_del_all();
 
-   while ((pc = chunk_get_head()) != NULL)
-   {
-      chunk_del(pc);
-   }
+   /* The symbols are only used by the chunks, so start over with them */
+   unc_text::clear_symbols();
+   unc_text::clear_logtext();
+   clear_keyword_cache();
 
    /* Clean up some state variables */
    cpd.unc_off     = false;
@@ -1758,12 +2285,11 @@ const char *get_file_extension(int& idx)
 
 /**
  * Find the language for the file extension
- * Default to C
  *
  * @param filename   The name of the file
- * @return           LANG_xxx
+ * @return           LANG_xxx or 0 (unknown extension)
  */
-static int language_from_filename(const char *filename)
+int language_from_extension(const char *filename)
 {
    int i;
 
@@ -1774,7 +2300,22 @@ static int language_from_filename(const char *filename)
          return(languages[i].lang);
       }
    }
-   return(LANG_C);
+   return(0);
+}
+
+
+/**
+ * Find the language for the file extension
+ * Default to C
+ *
+ * @param filename   The name of the file
+ * @return           LANG_xxx
+ */
+int language_from_filename(const char *filename)
+{
+   int lang = language_from_extension(filename);
+
+   return((lang != 0) ? lang : LANG_C);
 }
 
 
@@ -1784,7 +2325,7 @@ static int language_from_filename(const char *filename)
  * @param filename   The name of the file
  * @return           LANG_xxx or 0 (no match)
  */
-static int language_from_tag(const char *tag)
+int language_from_tag(const char *tag)
 {
    int i;
 
@@ -1805,7 +2346,7 @@ static int language_from_tag(const char *tag)
  * @param lang    The LANG_xxx enum
  * @return        A string
  */
-static const char *language_to_string(int lang)
+const char *language_to_string(int lang)
 {
    int i;
 
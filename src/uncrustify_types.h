@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <deque>
+#include <memory>
 using namespace std;
 
 #include "base_types.h"
@@ -20,6 +21,7 @@ using namespace std;
 #include "logger.h"
 #include "unc_text.h"
 #include <cstdio>
+#include <cstring>
 #include <assert.h>
 #ifdef HAVE_UTIME_H
 #include <utime.h>
@@ -56,6 +58,8 @@ enum CharEncoding
 };
 
 struct chunk_t;
+struct dkw_table;
+struct define_table;
 
 /**
  * Structure for counting nested level
@@ -77,26 +81,66 @@ struct paren_stack_entry
    bool      non_vardef;   /**< Hit a non-vardef line */
 };
 
-/* TODO: put this on a linked list */
+/**
+ * The paren stack grows as needed and never shrinks, so that the entries
+ * just above pse_tos keep their old values, which some code relies on.
+ * The new entries start out zeroed.
+ * Copying a frame only copies the entries that were ever used.
+ */
 struct parse_frame
 {
-   int                      ref_no;
-   int                      level;           // level of parens/square/angle/brace
-   int                      brace_level;     // level of brace/vbrace
-   int                      pp_level;        // level of preproc #if stuff
+   int                       ref_no;
+   int                       level;           // level of parens/square/angle/brace
+   int                       brace_level;     // level of brace/vbrace
+   int                       pp_level;        // level of preproc #if stuff
+
+   int                       sparen_count;
+
+   vector<paren_stack_entry> pse;
+   int                       pse_tos;
+   int                       paren_count;
+
+   c_token_t                 in_ifdef;
+   int                       stmt_count;
+   int                       expr_count;
 
-   int                      sparen_count;
+   bool                      maybe_decl;
+   bool                      maybe_cast;
 
-   struct paren_stack_entry pse[128];
-   int                      pse_tos;
-   int                      paren_count;
+   parse_frame()
+   {
+      reset();
+   }
 
-   c_token_t                in_ifdef;
-   int                      stmt_count;
-   int                      expr_count;
+   void reset()
+   {
+      ref_no       = 0;
+      level        = 0;
+      brace_level  = 0;
+      pp_level     = 0;
+      sparen_count = 0;
+      pse.assign(2, paren_stack_entry());
+      pse_tos      = 0;
+      paren_count  = 0;
+      in_ifdef     = CT_NONE;
+      stmt_count   = 0;
+      expr_count   = 0;
+      maybe_decl   = false;
+      maybe_cast   = false;
+   }
 
-   bool                     maybe_decl;
-   bool                     maybe_cast;
+   /**
+    * Moves the top of the paren stack up by one.
+    * There is always an entry above the top.
+    */
+   void pse_push()
+   {
+      pse_tos++;
+      if ((int)pse.size() < pse_tos + 2)
+      {
+         pse.resize(pse_tos + 2);
+      }
+   }
 };
 
 #define PCF_BIT(b)   (1ULL << b)
@@ -117,6 +161,8 @@ struct parse_frame
 #define PCF_IN_NAMESPACE       PCF_BIT(11)
 #define PCF_IN_FOR             PCF_BIT(12)
 #define PCF_IN_OC_MSG          PCF_BIT(13)
+#define PCF_IN_LINES           PCF_BIT(14)  /* in a region that is output for '--lines' */
+#define PCF_LINES_CTX          PCF_BIT(15)  /* formatted with a '--lines' region, not output */
 
 /* Non-Copy flags are in the upper 48 bits */
 #define PCF_FORCE_SPACE        PCF_BIT(16)  /* must have a space after this token */
@@ -158,8 +204,8 @@ static const char *pcf_names[] =
    "IN_NAMESPACE",      // 11
    "IN_FOR",            // 12
    "IN_OC_MSG",         // 13
-   "#14",               // 14
-   "#15",               // 15
+   "IN_LINES",          // 14
+   "LINES_CTX",         // 15
    "FORCE_SPACE",       // 16
    "STMT_START",        // 17
    "EXPR_START",        // 18
@@ -203,6 +249,34 @@ struct align_ptr_t
    chunk_t *start;
 };
 
+/**
+ * The cached links of a chunk, see chunk_list.cpp.
+ * Kept out of chunk_t so that walking the list touches fewer cache lines.
+ */
+struct chunk_links_t
+{
+   /* The generations of the cached links below */
+   UINT32  nav_gen;
+   UINT32  match_gen;
+   UINT32  scope_gen;
+   UINT32  line_gen;
+
+   /* Cached results of the navigation functions */
+   chunk_t *nav_next_nc;
+   chunk_t *nav_prev_nc;
+   chunk_t *nav_next_ncnl;
+   chunk_t *nav_prev_ncnl;
+
+   /* The match of a paren/brace/square and the innermost one that this
+    * chunk is in */
+   chunk_t *match;
+   chunk_t *scope;
+
+   /* The first chunk on the line and the newline that ends it */
+   chunk_t *line_first;
+   chunk_t *line_nl;
+};
+
 /** This is the main type of this program */
 struct chunk_t
 {
@@ -212,23 +286,24 @@ struct chunk_t
    }
    void reset()
    {
-      memset(&align, 0, sizeof(align));
       next = 0;
       prev = 0;
+      flags = 0;
       type = CT_NONE;
       parent_type = CT_NONE;
-      orig_line = 0;
-      orig_col = 0;
-      orig_col_end = 0;
-      flags = 0;
-      column = 0;
-      column_indent = 0;
-      nl_count = 0;
       level = 0;
       brace_level = 0;
       pp_level = 0;
+      column = 0;
+      column_indent = 0;
+      nl_count = 0;
+      orig_line = 0;
+      orig_col = 0;
+      orig_col_end = 0;
       after_tab = false;
       str.clear();
+      links = NULL;
+      align = NULL;
    }
    int len()
    {
@@ -239,24 +314,31 @@ struct chunk_t
       return str.c_str();
    }
 
+   /* The fields that nearly every pass looks at come first */
    chunk_t     *next;
    chunk_t     *prev;
-   align_ptr_t align;
+   UINT64      flags;            /* see PCF_xxx */
    c_token_t   type;
    c_token_t   parent_type;     /* usually CT_NONE */
-   UINT32      orig_line;
-   UINT32      orig_col;
-   UINT32      orig_col_end;
-   UINT64      flags;            /* see PCF_xxx */
+   int         level;            /* nest level in {, (, or [ */
+   int         brace_level;      /* nest level in braces only */
+   int         pp_level;         /* nest level in #if stuff */
    int         column;           /* column of chunk */
    int         column_indent;    /* if 1st on a line, set to the 'indent'
                                   * column, which may be less that the real column */
    int         nl_count;         /* number of newlines in CT_NEWLINE */
-   int         level;            /* nest level in {, (, or [ */
-   int         brace_level;      /* nest level in braces only */
-   int         pp_level;         /* nest level in #if stuff */
+   UINT32      orig_line;
+   UINT32      orig_col;
+   UINT32      orig_col_end;
    bool        after_tab;        /* whether this token was after a tab */
-   unc_text    str;             /* pointer to the token text */
+
+   unc_text    str;              /* the token text */
+
+   /* NULL until a cached link is used, see chunk_list.cpp */
+   chunk_links_t *links;
+
+   /* NULL until the chunk is aligned, see chunk_align() */
+   align_ptr_t *align;
 };
 
 enum
@@ -299,14 +381,6 @@ struct chunk_tag_t
    int        lang_flags;
 };
 
-struct lookup_entry_t
-{
-   char              ch;
-   char              left_in_group;
-   UINT16            next_idx;
-   const chunk_tag_t *tag;
-};
-
 struct align_t
 {
    int       col;
@@ -314,20 +388,97 @@ struct align_t
    int       len;    // of the token + space
 };
 
+/**
+ * A range of input lines, for '--lines'
+ */
+struct line_range
+{
+   int first;
+   int last;
+};
+
+/**
+ * A loaded source file.
+ * The bytes are either read into 'raw' or mapped (see load_mem_file()).
+ * Plain ASCII text is tokenized straight from the bytes, anything else is
+ * decoded into 'data' first.
+ */
 struct file_mem
 {
-   vector<UINT8>  raw;
-   deque<int>     data;
-   bool           bom;
-   CharEncoding   enc;
+   vector<UINT8>           raw;
+   shared_ptr<const UINT8> map;     /* the mapped file, unmapped when released */
+   size_t                  map_len;
+   vector<int>             data;    /* the decoded text, empty if 'ascii' or 'utf8' */
+   bool                    ascii;   /* the bytes are the text */
+   bool                    utf8;    /* the bytes are the text, in UTF-8 after the BOM */
+   bool                    bom;
+   CharEncoding            enc;
 #ifdef HAVE_UTIME_H
-   struct utimbuf utb;
+   struct utimbuf          utb;
 #endif
+
+   file_mem() : map_len(0), ascii(false), utf8(false), bom(false), enc(ENC_ASCII)
+   {
+   }
+
+   const UINT8 *bytes() const
+   {
+      return((map != NULL) ? map.get() : (raw.empty() ? NULL : &raw[0]));
+   }
+
+   size_t size() const
+   {
+      return((map != NULL) ? map_len : raw.size());
+   }
+
+   /* where the text starts in the bytes */
+   size_t text_start() const
+   {
+      return((utf8 && bom) ? 3 : 0);
+   }
+
+   /* the number of chars in the text */
+   size_t length() const
+   {
+      if (utf8)
+      {
+         /* count all but the UTF-8 continuation bytes */
+         size_t      cnt  = 0;
+         const UINT8 *ptr = bytes();
+         for (size_t idx = text_start(); idx < size(); idx++)
+         {
+            cnt += ((ptr[idx] & 0xC0) != 0x80) ? 1 : 0;
+         }
+         return(cnt);
+      }
+      return(ascii ? size() : data.size());
+   }
+
+   bool same_as(const vector<UINT8>& out) const
+   {
+      return((out.size() == size()) &&
+             ((out.size() == 0) || (memcmp(&out[0], bytes(), out.size()) == 0)));
+   }
 };
 
+/**
+ * The formatting context.
+ * There is one of these per thread, so that several files can be processed
+ * in parallel (see the '-j' option). The settings, keywords and defines are
+ * loaded in the main thread before any worker is started and are treated as
+ * read-only from then on.
+ */
 struct cp_data
 {
-   FILE               *fout;
+   vector<UINT8>      *out;       /* where output_text() renders to */
+   const file_mem     *out_cmp;   /* NULL or the file to compare the output with */
+   size_t             out_cmp_pos; /* bytes of out_cmp that matched so far */
+   bool               out_differs; /* the output did not match out_cmp */
+   vector<line_range> lines;       /* only format these input lines, all if empty */
+   vector<line_range> line_regions; /* the input lines of each region that is output */
+   bool               lines_ifdef; /* the whole file is in one #if, for '--lines' */
+   dkw_table          *keywords;  /* the type/macro-* entries, NULL for the shared ones */
+   define_table       *defines;   /* the define entries, NULL for the shared ones */
 
    UINT32             error_count;
    const char         *filename;
@@ -345,6 +496,7 @@ struct cp_data
    UINT32             line_number;
    UINT16             column;  /* column for parsing */
    UINT16             spaces;  /* space count on output */
+   int                last_char; /* last char passed to add_char() */
 
    bool               frag;
    UINT16             frag_cols;
@@ -374,11 +526,11 @@ struct cp_data
    op_val_t           settings[UO_option_count];
    int                max_option_name_len;
 
-   struct parse_frame frames[16];
+   vector<parse_frame> frames;     /* the #if stack, see parse_frame.cpp */
    int                frame_count;
    int                pp_level;
 };
 
-extern struct cp_data cpd;
+extern thread_local struct cp_data cpd;
 
 #endif   /* UNCRUSTIFY_TYPES_H_INCLUDED */
@@ -15,10 +15,10 @@
 /**
  * See if all characters are ASCII (0-127)
  */
-bool is_ascii(const vector<UINT8>& data, int& non_ascii_cnt, int& zero_cnt)
+bool is_ascii(const UINT8 *data, size_t len, int& non_ascii_cnt, int& zero_cnt)
 {
    non_ascii_cnt = zero_cnt = 0;
-   for (int idx = 0; idx < (int)data.size(); idx++)
+   for (size_t idx = 0; idx < len; idx++)
    {
       if (data[idx] & 0x80)
       {
@@ -36,10 +36,10 @@ bool is_ascii(const vector<UINT8>& data, int& non_ascii_cnt, int& zero_cnt)
 /**
  * Convert the array of bytes into an array of ints
  */
-bool decode_bytes(const vector<UINT8>& in_data, deque<int>& out_data)
+bool decode_bytes(const UINT8 *in_data, size_t in_len, vector<int>& out_data)
 {
-   out_data.resize(in_data.size());
-   for (int idx = 0; idx < (int)in_data.size(); idx++)
+   out_data.resize(in_len);
+   for (size_t idx = 0; idx < in_len; idx++)
    {
       out_data[idx] = in_data[idx];
    }
@@ -104,16 +104,20 @@ void encode_utf8(int ch, vector<UINT8>& res)
 /**
  * Decode UTF-8 sequences from in_data and put the chars in out_data.
  * If there are any decoding errors, then return false.
+ * If out_data is NULL, then the sequences are only checked.
  */
-bool decode_utf8(const vector<UINT8>& in_data, deque<int>& out_data)
+bool decode_utf8(const UINT8 *in_data, size_t in_len, vector<int> *out_data)
 {
-   int idx = 0;
-   int ch, tmp, cnt;
+   size_t idx = 0;
+   int    ch, tmp, cnt;
 
-   out_data.clear();
+   if (out_data != NULL)
+   {
+      out_data->clear();
+   }
 
    /* check for UTF-8 BOM silliness and skip */
-   if (in_data.size() >= 3)
+   if (in_len >= 3)
    {
       if ((in_data[0] == 0xef) &&
           (in_data[1] == 0xbb) &&
@@ -124,12 +128,15 @@ bool decode_utf8(const vector<UINT8>& in_data, deque<int>& out_data)
       }
    }
 
-   while (idx < (int)in_data.size())
+   while (idx < in_len)
    {
       ch = in_data[idx++];
       if (ch < 0x80)                   /* 1-byte sequence */
       {
-         out_data.push_back(ch);
+         if (out_data != NULL)
+         {
+            out_data->push_back(ch);
+         }
          continue;
       }
       else if ((ch & 0xE0) == 0xC0)    /* 2-byte sequence */
@@ -163,7 +170,7 @@ bool decode_utf8(const vector<UINT8>& in_data, deque<int>& out_data)
          return false;
       }
 
-      while ((cnt-- > 0) && (idx < (int)in_data.size()))
+      while ((cnt-- > 0) && (idx < in_len))
       {
          tmp = in_data[idx++];
          if ((tmp & 0xC0) != 0x80)
@@ -178,7 +185,10 @@ bool decode_utf8(const vector<UINT8>& in_data, deque<int>& out_data)
          /* short UTF-8 sequence */
          return false;
       }
-      out_data.push_back(ch);
+      if (out_data != NULL)
+      {
+         out_data->push_back(ch);
+      }
    }
    return true;
 }
@@ -187,11 +197,11 @@ bool decode_utf8(const vector<UINT8>& in_data, deque<int>& out_data)
 /**
  * Extract 2 bytes from the stream and increment idx by 2
  */
-static int get_word(const vector<UINT8>& in_data, int& idx, bool be)
+static int get_word(const UINT8 *in_data, size_t in_len, size_t& idx, bool be)
 {
    int ch;
 
-   if ((idx + 2) > (int)in_data.size())
+   if ((idx + 2) > in_len)
    {
       ch = -1;
    }
@@ -213,23 +223,23 @@ static int get_word(const vector<UINT8>& in_data, int& idx, bool be)
  * Sets enc based on the BOM.
  * Must have the BOM as the first two bytes.
  */
-bool decode_utf16(const vector<UINT8>& in_data, deque<int>& out_data, CharEncoding& enc)
+bool decode_utf16(const UINT8 *in_data, size_t in_len, vector<int>& out_data, CharEncoding& enc)
 {
    out_data.clear();
 
-   if (in_data.size() & 1)
+   if (in_len & 1)
    {
       /* can't have and odd length */
       return false;
    }
 
-   if (in_data.size() < 2)
+   if (in_len < 2)
    {
       /* we require the BOM or at least 1 char */
       return false;
    }
 
-   int idx = 2;
+   size_t idx = 2;
    if ((in_data[0] == 0xfe) && (in_data[1] == 0xff))
    {
       enc = ENC_UTF16_BE;
@@ -244,7 +254,7 @@ bool decode_utf16(const vector<UINT8>& in_data, deque<int>& out_data, CharEncodi
        * chars are ASCII */
       enc = ENC_ASCII;
       idx = 0;
-      if (in_data.size() >= 6)
+      if (in_len >= 6)
       {
          if ((in_data[0] == 0) && (in_data[2] == 0) && (in_data[4] == 0))
          {
@@ -263,14 +273,14 @@ bool decode_utf16(const vector<UINT8>& in_data, deque<int>& out_data, CharEncodi
 
    bool be = (enc == ENC_UTF16_BE);
 
-   while (idx < (int)in_data.size())
+   while (idx < in_len)
    {
-      int ch = get_word(in_data, idx, be);
+      int ch = get_word(in_data, in_len, idx, be);
       if ((ch & 0xfc00) == 0xd800)
       {
          ch  &= 0x3ff;
          ch <<= 10;
-         int tmp = get_word(in_data, idx, be);
+         int tmp = get_word(in_data, in_len, idx, be);
          if ((tmp & 0xfc00) != 0xdc00)
          {
             return false;
@@ -298,10 +308,10 @@ bool decode_utf16(const vector<UINT8>& in_data, deque<int>& out_data, CharEncodi
  * If found, set enc and return true.
  * Sets enc to ENC_ASCII and returns false if not found.
  */
-bool decode_bom(const vector<UINT8>& in_data, CharEncoding& enc)
+bool decode_bom(const UINT8 *in_data, size_t in_len, CharEncoding& enc)
 {
    enc = ENC_ASCII;
-   if (in_data.size() >= 2)
+   if (in_len >= 2)
    {
       if ((in_data[0] == 0xfe) && (in_data[1] == 0xff))
       {
@@ -313,7 +323,7 @@ bool decode_bom(const vector<UINT8>& in_data, CharEncoding& enc)
          enc = ENC_UTF16_LE;
          return true;
       }
-      else if ((in_data.size() >= 3) &&
+      else if ((in_len >= 3) &&
                (in_data[0] == 0xef) &&
                (in_data[1] == 0xbb) &&
                (in_data[2] == 0xbf))
@@ -329,19 +339,19 @@ bool decode_bom(const vector<UINT8>& in_data, CharEncoding& enc)
 /**
  * Figure out the encoding and convert to an int sequence
  */
-bool decode_unicode(const vector<UINT8>& in_data, deque<int>& out_data, CharEncoding& enc, bool& has_bom)
+bool decode_unicode(const UINT8 *in_data, size_t in_len, vector<int>& out_data, CharEncoding& enc, bool& has_bom)
 {
    /* check for a BOM */
-   if (decode_bom(in_data, enc))
+   if (decode_bom(in_data, in_len, enc))
    {
       has_bom = true;
       if (enc == ENC_UTF8)
       {
-         return decode_utf8(in_data, out_data);
+         return decode_utf8(in_data, in_len, &out_data);
       }
       else
       {
-         return decode_utf16(in_data, out_data, enc);
+         return decode_utf16(in_data, in_len, out_data, enc);
       }
    }
    has_bom = false;
@@ -349,24 +359,24 @@ bool decode_unicode(const vector<UINT8>& in_data, deque<int>& out_data, CharEnco
    /* Check for simple ASCII */
    int non_ascii_cnt;
    int zero_cnt;
-   if (is_ascii(in_data, non_ascii_cnt, zero_cnt))
+   if (is_ascii(in_data, in_len, non_ascii_cnt, zero_cnt))
    {
       enc = ENC_ASCII;
-      return decode_bytes(in_data, out_data);
+      return decode_bytes(in_data, in_len, out_data);
    }
 
    /* There are alot of 0's in UTF-16 (~50%) */
-   if ((zero_cnt > ((int)in_data.size() / 4)) &&
-       (zero_cnt <= ((int)in_data.size() / 2)))
+   if ((zero_cnt > ((int)in_len / 4)) &&
+       (zero_cnt <= ((int)in_len / 2)))
    {
       /* likely is UTF-16 */
-      if (decode_utf16(in_data, out_data, enc))
+      if (decode_utf16(in_data, in_len, out_data, enc))
       {
          return true;
       }
    }
 
-   if (decode_utf8(in_data, out_data))
+   if (decode_utf8(in_data, in_len, &out_data))
    {
       enc = ENC_UTF8;
       return true;
@@ -374,18 +384,56 @@ bool decode_unicode(const vector<UINT8>& in_data, deque<int>& out_data, CharEnco
 
    /* it is an unrecognized byte sequence */
    enc = ENC_BYTE;
-   return decode_bytes(in_data, out_data);
+   return decode_bytes(in_data, in_len, out_data);
+}
+
+
+/**
+ * Figures out the encoding of a loaded file.
+ * Plain ASCII and valid UTF-8 are left as they are, as the tokenizer reads
+ * them straight from the bytes. Anything else is decoded into fm.data.
+ * Text with a 0 in it is decoded too, so that uncrustify_file() finds the 0.
+ */
+bool decode_file(file_mem& fm)
+{
+   const UINT8 *in = fm.bytes();
+   size_t      len = fm.size();
+   int         non_ascii_cnt;
+   int         zero_cnt;
+
+   fm.data.clear();
+   fm.bom   = false;
+   fm.utf8  = false;
+   fm.ascii = is_ascii(in, len, non_ascii_cnt, zero_cnt);
+   if (fm.ascii)
+   {
+      fm.enc = ENC_ASCII;
+      return(true);
+   }
+
+   /* Without 0's it isn't UTF-16, unless there is a BOM that says so */
+   CharEncoding enc;
+   bool         bom = decode_bom(in, len, enc);
+   if ((zero_cnt == 0) && (!bom || (enc == ENC_UTF8)) &&
+       decode_utf8(in, len, NULL))
+   {
+      fm.utf8 = true;
+      fm.bom  = bom;
+      fm.enc  = ENC_UTF8;
+      return(true);
+   }
+   return(decode_unicode(in, len, fm.data, fm.enc, fm.bom));
 }
 
 
 /**
  * Write for ASCII and BYTE encoding
  */
-void write_byte(int ch, FILE *pf)
+void write_byte(int ch, vector<UINT8>& out)
 {
    if (ch < 0x100)
    {
-      fputc(ch, pf);
+      out.push_back(ch);
    }
    else
    {
@@ -395,32 +443,28 @@ void write_byte(int ch, FILE *pf)
 
 
 /**
- * Writes a single character to a file using UTF-8 encoding
+ * Writes a single character using UTF-8 encoding
  */
-void write_utf8(int ch, FILE *pf)
+void write_utf8(int ch, vector<UINT8>& out)
 {
-   vector<UINT8> dq;
-   dq.reserve(6);
-
-   encode_utf8(ch, dq);
-   fwrite(&dq[0], dq.size(), 1, pf);
+   encode_utf8(ch, out);
 }
 
 
-void write_utf16(int ch, bool be, FILE *pf)
+void write_utf16(int ch, bool be, vector<UINT8>& out)
 {
    /* U+0000 to U+D7FF and U+E000 to U+FFFF */
    if (((ch >= 0) && (ch < 0xD800)) || ((ch >= 0xE000) && (ch < 0x10000)))
    {
       if (be)
       {
-         fputc((ch >> 8), pf);
-         fputc((ch & 0xff), pf);
+         out.push_back(ch >> 8);
+         out.push_back(ch & 0xff);
       }
       else
       {
-         fputc((ch & 0xff), pf);
-         fputc((ch >> 8), pf);
+         out.push_back(ch & 0xff);
+         out.push_back(ch >> 8);
       }
    }
    else if ((ch >= 0x10000) && (ch < 0x110000))
@@ -430,17 +474,17 @@ void write_utf16(int ch, bool be, FILE *pf)
       int w2 = 0xDC00 + (v1 & 0x3ff);
       if (be)
       {
-         fputc((w1 >> 8), pf);
-         fputc((w1 & 0xff), pf);
-         fputc((w2 >> 8), pf);
-         fputc((w2 & 0xff), pf);
+         out.push_back(w1 >> 8);
+         out.push_back(w1 & 0xff);
+         out.push_back(w2 >> 8);
+         out.push_back(w2 & 0xff);
       }
       else
       {
-         fputc((w1 & 0xff), pf);
-         fputc((w1 >> 8), pf);
-         fputc((w2 & 0xff), pf);
-         fputc((w2 >> 8), pf);
+         out.push_back(w1 & 0xff);
+         out.push_back(w1 >> 8);
+         out.push_back(w2 & 0xff);
+         out.push_back(w2 >> 8);
       }
    }
    else
@@ -450,22 +494,22 @@ void write_utf16(int ch, bool be, FILE *pf)
 }
 
 
-void write_bom(FILE *pf, CharEncoding enc)
+void write_bom(vector<UINT8>& out, CharEncoding enc)
 {
    switch (enc)
    {
    case ENC_UTF8:
-      write_byte(0xef, pf);
-      write_byte(0xbb, pf);
-      write_byte(0xbf, pf);
+      write_byte(0xef, out);
+      write_byte(0xbb, out);
+      write_byte(0xbf, out);
       break;
 
    case ENC_UTF16_LE:
-      write_utf16(0xfeff, false, pf);
+      write_utf16(0xfeff, false, out);
       break;
 
    case ENC_UTF16_BE:
-      write_utf16(0xfeff, true, pf);
+      write_utf16(0xfeff, true, out);
       break;
 
    default:
@@ -475,53 +519,81 @@ void write_bom(FILE *pf, CharEncoding enc)
 
 
 /**
+ * Appends a single character to the output buffer.
+ *
  * @param ch the 31-bit char value
  */
-void write_char(FILE *pf, int ch, CharEncoding enc)
+void write_char(vector<UINT8>& out, int ch, CharEncoding enc)
 {
-   if (ch >= 0)
+   /* Plain ASCII is the same in all of the byte encodings */
+   if ((ch >= 0) && (ch < 0x80) &&
+       (enc != ENC_UTF16_LE) && (enc != ENC_UTF16_BE))
+   {
+      out.push_back(ch);
+   }
+   else if (ch >= 0)
    {
       switch (enc)
       {
       case ENC_BYTE:
-         write_byte(ch & 0xff, pf);
+         write_byte(ch & 0xff, out);
          break;
 
       case ENC_ASCII:
       default:
-         write_byte(ch, pf);
+         write_byte(ch, out);
          break;
 
       case ENC_UTF8:
-         write_utf8(ch, pf);
+         write_utf8(ch, out);
          break;
 
       case ENC_UTF16_LE:
-         write_utf16(ch, false, pf);
+         write_utf16(ch, false, out);
          break;
 
       case ENC_UTF16_BE:
-         write_utf16(ch, true, pf);
+         write_utf16(ch, true, out);
          break;
       }
    }
 }
 
 
-void write_string(FILE *pf, const char *ascii_text, CharEncoding enc)
+/**
+ * Appends a run of the same character to the output buffer.
+ */
+void write_chars(vector<UINT8>& out, int ch, int count, CharEncoding enc)
+{
+   if ((ch >= 0) && (ch < 0x80) &&
+       (enc != ENC_UTF16_LE) && (enc != ENC_UTF16_BE))
+   {
+      out.insert(out.end(), count, (UINT8)ch);
+   }
+   else
+   {
+      while (count-- > 0)
+      {
+         write_char(out, ch, enc);
+      }
+   }
+}
+
+
+void write_string(vector<UINT8>& out, const char *ascii_text, CharEncoding enc)
 {
    while (*ascii_text)
    {
-      write_char(pf, *ascii_text, enc);
+      write_char(out, *ascii_text, enc);
       ascii_text++;
    }
 }
 
 
-void write_string(FILE *pf, const deque<int>& text, CharEncoding enc)
+void write_string(vector<UINT8>& out, const vector<int>& text, CharEncoding enc)
 {
    for (int idx = 0; idx < (int)text.size(); idx++)
    {
-      write_char(pf, text[idx], enc);
+      write_char(out, text[idx], enc);
    }
 }
@@ -326,8 +326,7 @@ static void split_line(chunk_t *start)
           (start->type == CT_ANGLE_CLOSE) ||
           (start->type == CT_BRACE_CLOSE) ||
           (start->type == CT_COMMA) ||
-          (start->type == CT_SEMICOLON) ||
-          (start->type == CT_VSEMICOLON) ||
+          chunk_is_semicolon(start) ||
           (start->len() == 0))
       {
          LOG_FMT(LSPLIT, " ** NO GO **\n");
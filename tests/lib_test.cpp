@@ -0,0 +1,108 @@
+/**
+ * @file lib_test.cpp
+ * Formats with several configs through libuncrustify and checks that each
+ * config gives the same output as the command line, whatever configs were
+ * used before it.
+ * This is run from the tests folder after run_cli_tests.py, see run_tests.sh.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "libuncrustify.h"
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+
+struct lib_test
+{
+   const char *name;
+   const char *lang;
+   const char *cfg_file;
+   const char *input;
+   const char *expected;   /* NULL if the config must fail to load */
+};
+
+/**
+ * The macro-open, etc entries of custom-open.cfg must not apply to the other
+ * configs, also when they are loaded after it or fail to load.
+ * The last one formats UTF-8 text, which is read in place from the input.
+ */
+static const lib_test lib_tests[] =
+{
+   { "macros",          "CPP", "config/custom-open.cfg",       "input/cpp/custom-open.cpp", "output/cpp/30016-custom-open.cpp" },
+   { "no-macros",       "CPP", "config/custom-open-plain.cfg", "input/cpp/custom-open.cpp", "output/cpp/30036-custom-open.cpp" },
+   { "missing-config",  "CPP", "config/no-such-file.cfg",      "input/cpp/custom-open.cpp", NULL                               },
+   { "macros-again",    "CPP", "config/custom-open.cfg",       "input/cpp/custom-open.cpp", "output/cpp/30016-custom-open.cpp" },
+   { "macros-2",        "CPP", "config/custom-open2.cfg",      "input/cpp/custom-open.cpp", "output/cpp/30017-custom-open.cpp" },
+   { "no-macros-again", "CPP", "config/custom-open-plain.cfg", "input/cpp/custom-open.cpp", "output/cpp/30036-custom-open.cpp" },
+   { "utf8",            "C",   "config/cmt_multi-2.cfg",       "input/c/cmt_multi_utf8.c",  "output/c/02423-cmt_multi_utf8.c"  },
+};
+
+
+static bool read_file(const char *filename, vector<uint8_t>& data)
+{
+   FILE *pfile = fopen(filename, "rb");
+
+   data.clear();
+   if (pfile == NULL)
+   {
+      fprintf(stderr, "Unable to open %s\n", filename);
+      return(false);
+   }
+
+   uint8_t buf[4096];
+   size_t  len;
+   while ((len = fread(buf, 1, sizeof(buf), pfile)) > 0)
+   {
+      data.insert(data.end(), buf, buf + len);
+   }
+   fclose(pfile);
+   return(true);
+}
+
+
+static bool run_test(const lib_test& test)
+{
+   vector<uint8_t> input;
+   vector<uint8_t> expected;
+   vector<uint8_t> out;
+
+   if (!read_file(test.input, input) ||
+       ((test.expected != NULL) && !read_file(test.expected, expected)))
+   {
+      return(false);
+   }
+
+   int lang = uncrustify_language(test.lang);
+   int res  = uncrustify_format(test.cfg_file, lang, &input[0], input.size(), out);
+   if (test.expected == NULL)
+   {
+      return((res == -1) && out.empty());
+   }
+   return((res == 0) && (out == expected));
+}
+
+
+int main(void)
+{
+   int pass_count = 0;
+   int fail_count = 0;
+
+   for (size_t idx = 0; idx < sizeof(lib_tests) / sizeof(lib_tests[0]); idx++)
+   {
+      if (run_test(lib_tests[idx]))
+      {
+         pass_count++;
+      }
+      else
+      {
+         fail_count++;
+         printf("FAILED: %s\n", lib_tests[idx].name);
+      }
+   }
+
+   printf("Passed %d / %d library tests\n", pass_count, pass_count + fail_count);
+   return((fail_count > 0) ? 1 : 0);
+}
@@ -0,0 +1,124 @@
+/**
+ * @file mem_bench.cpp
+ * Reports the size of the chunk structures and what the chunks of each file
+ * use while it is formatted through libuncrustify.
+ *
+ * Usage: mem_bench CFG_FILE LANG FILE...
+ *
+ * Built with 'make check', but not run by the tests, as the numbers depend
+ * on the machine.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "libuncrustify.h"
+#include "chunk_list.h"
+#include <cstdio>
+#include <vector>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+
+static bool read_file(const char *filename, vector<uint8_t>& data)
+{
+   FILE *pfile = fopen(filename, "rb");
+
+   data.clear();
+   if (pfile == NULL)
+   {
+      fprintf(stderr, "Unable to open %s\n", filename);
+      return(false);
+   }
+
+   uint8_t buf[4096];
+   size_t  len;
+   while ((len = fread(buf, 1, sizeof(buf), pfile)) > 0)
+   {
+      data.insert(data.end(), buf, buf + len);
+   }
+   fclose(pfile);
+   return(true);
+}
+
+
+static double now_ms(void)
+{
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+   return(tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0);
+}
+
+
+static long max_rss_kb(void)
+{
+   struct rusage ru;
+
+   if (getrusage(RUSAGE_SELF, &ru) != 0)
+   {
+      return(0);
+   }
+   return(ru.ru_maxrss);
+}
+
+
+int main(int argc, char *argv[])
+{
+   if (argc < 4)
+   {
+      fprintf(stderr, "Usage: %s CFG_FILE LANG FILE...\n", argv[0]);
+      return(2);
+   }
+
+   int lang = uncrustify_language(argv[2]);
+   if (lang == 0)
+   {
+      fprintf(stderr, "Unknown language %s\n", argv[2]);
+      return(2);
+   }
+
+   printf("sizeof(chunk_t)       = %u\n", (unsigned)sizeof(chunk_t));
+   printf("sizeof(unc_text)      = %u\n", (unsigned)sizeof(unc_text));
+   printf("sizeof(chunk_links_t) = %u\n", (unsigned)sizeof(chunk_links_t));
+   printf("sizeof(align_ptr_t)   = %u\n", (unsigned)sizeof(align_ptr_t));
+   printf("\n%-30s %8s %8s %8s %10s %10s %10s %10s %9s %9s\n",
+          "file", "chunks", "links", "aligns", "chunk KB", "side KB",
+          "text KB", "log KB", "ms", "rss KB");
+
+   int errors = 0;
+   for (int idx = 3; idx < argc; idx++)
+   {
+      vector<uint8_t> input;
+      vector<uint8_t> out;
+
+      if (!read_file(argv[idx], input))
+      {
+         errors++;
+         continue;
+      }
+
+      double start = now_ms();
+      int    res   = uncrustify_format(argv[1], lang,
+                                       input.empty() ? NULL : &input[0],
+                                       input.size(), out);
+      double end = now_ms();
+      if (res < 0)
+      {
+         fprintf(stderr, "Failed to format %s\n", argv[idx]);
+         errors++;
+         continue;
+      }
+
+      chunk_mem_t st;
+      chunk_mem_stats(st);
+      size_t side = st.links * sizeof(chunk_links_t) + st.aligns * sizeof(align_ptr_t);
+      printf("%-30s %8u %8u %8u %10.1f %10.1f %10.1f %10.1f %9.1f %9ld\n",
+             argv[idx], (unsigned)st.chunks, (unsigned)st.links, (unsigned)st.aligns,
+             st.chunks * sizeof(chunk_t) / 1024.0, side / 1024.0,
+             st.text_bytes / 1024.0, st.log_bytes / 1024.0,
+             end - start, max_rss_kb());
+   }
+   return((errors > 0) ? 1 : 0);
+}
@@ -0,0 +1,9 @@
+@@ 15-21 @@
+void f()
+{
+   for ( ; ; )
+   {
+      nothing();
+   }
+   foobar();
+}
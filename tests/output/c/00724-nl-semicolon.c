@@ -0,0 +1,22 @@
+@@ 1-10 @@
+void foo(void)
+{
+   a = 5;
+   b = 3;
+   j = 6;
+
+   for (a = 0; a < j; a++)
+   {
+      b *= (a + b);
+   }
+}
+
+@@ 15-21 @@
+void f()
+{
+   for ( ; ; )
+   {
+      nothing();
+   }
+   foobar();
+}
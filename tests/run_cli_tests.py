@@ -0,0 +1,328 @@
+#! /usr/bin/env python
+#
+# Runs the command line modes that work on whole files and folders and the
+# --server protocol and checks the exit status and what they print or write.
+# This is run from the tests folder after run_tests.py, see run_tests.sh.
+#
+
+import sys
+import os
+import shutil
+import tempfile
+import subprocess
+import socket
+import time
+
+UNCRUSTIFY = os.path.join(os.path.abspath('../src'), 'uncrustify')
+CONFIG     = os.path.abspath('config/ben.cfg')
+
+# A file that ben.cfg leaves alone and the input it was made from
+GOOD_FILE  = os.path.abspath('output/c/00801-fcn_type.c')
+BAD_FILE   = os.path.abspath('input/c/fcn_type.c')
+
+pass_count = 0
+fail_count = 0
+
+def run(args, cwd=None, stdin=None):
+	"""Runs uncrustify with the config and returns the exit status and stdout"""
+	cmd = [UNCRUSTIFY, '-q', '-c', CONFIG] + args
+	proc = subprocess.Popen(cmd, cwd=cwd, stdin=stdin,
+	                        stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+	out, err = proc.communicate()
+	return proc.returncode, out
+
+def read_file(path):
+	fd = open(path, 'rb')
+	data = fd.read()
+	fd.close()
+	return data
+
+def check(test_name, ok, detail=None):
+	global pass_count, fail_count
+	if ok:
+		pass_count += 1
+	else:
+		fail_count += 1
+		print "FAILED: " + test_name
+		if detail:
+			print detail
+
+def make_folder(files):
+	"""Creates a temp folder with the files, a dict of name -> source file"""
+	tmp = tempfile.mkdtemp(prefix='unc-cli-')
+	for name, src in files.items():
+		path = os.path.join(tmp, name)
+		if not os.path.isdir(os.path.dirname(path)):
+			os.makedirs(os.path.dirname(path))
+		shutil.copyfile(src, path)
+	return tmp
+
+def list_files(top):
+	found = []
+	for root, dirs, files in os.walk(top):
+		for name in files:
+			found.append(os.path.relpath(os.path.join(root, name), top))
+	found.sort()
+	return found
+
+def test_check():
+	"""--check prints PASS/FAIL, exits with 1 if any file fails and writes nothing"""
+	tmp = make_folder({ 'good.c' : GOOD_FILE, 'bad.c' : BAD_FILE })
+	try:
+		rc, out = run(['--check', '-f', 'good.c'], cwd=tmp)
+		check('check-pass', (rc == 0) and out.startswith('PASS: good.c'), out)
+
+		rc, out = run(['--check', '-f', 'bad.c'], cwd=tmp)
+		check('check-fail', (rc == 1) and out.startswith('FAIL: bad.c'), out)
+
+		for jobs in [ '1', '2' ]:
+			rc, out = run(['--check', '-j', jobs, 'good.c', 'bad.c'], cwd=tmp)
+			check('check-files-j' + jobs,
+			      (rc == 1) and ('PASS: good.c' in out) and ('FAIL: bad.c' in out), out)
+
+		rc, out = run(['--check', '-l', 'c'], stdin=open(BAD_FILE, 'rb'))
+		check('check-stdin', (rc == 1) and out.startswith('FAIL: stdin'), out)
+
+		check('check-no-write', list_files(tmp) == [ 'bad.c', 'good.c' ], list_files(tmp))
+		check('check-unchanged', read_file(os.path.join(tmp, 'bad.c')) == read_file(BAD_FILE))
+	finally:
+		shutil.rmtree(tmp)
+
+def test_diff():
+	"""--diff prints a diff that 'patch -p1' applies to get the formatted files"""
+	tmp = make_folder({ 'good.c' : GOOD_FILE, 'bad.c' : BAD_FILE })
+	try:
+		# The last line of a file may not have a newline
+		fd = open(os.path.join(tmp, 'nonl.c'), 'wb')
+		fd.write('int main() {\n  return 0;\n}')
+		fd.close()
+
+		names = [ 'bad.c', 'good.c', 'nonl.c' ]
+		want  = {}
+		for name in names:
+			rc, want[name] = run(['-f', name], cwd=tmp)
+
+		rc, out = run(['--diff'] + names, cwd=tmp)
+		check('diff-status', rc == 0, out)
+		check('diff-files', ('--- a/bad.c' in out) and ('--- a/nonl.c' in out) and
+		      ('good.c' not in out), out)
+		check('diff-no-write', list_files(tmp) == names, list_files(tmp))
+
+		proc = subprocess.Popen(['patch', '-s', '-p1'], cwd=tmp, stdin=subprocess.PIPE)
+		proc.communicate(out)
+		check('diff-patch', proc.returncode == 0)
+		for name in names:
+			check('diff-patched-' + name, read_file(os.path.join(tmp, name)) == want[name])
+
+		rc, out = run(['--diff', '-f', 'good.c'], cwd=tmp)
+		check('diff-clean', (rc == 0) and (out == ''), out)
+	finally:
+		shutil.rmtree(tmp)
+
+	# An absolute path gets a header relative to the current folder
+	tmp = make_folder({ 'sub/bad.c' : BAD_FILE })
+	try:
+		path = os.path.join(os.path.realpath(tmp), 'sub', 'bad.c')
+		rc, want = run(['-f', path])
+		rc, out  = run(['--diff', path], cwd=os.path.realpath(tmp))
+		check('diff-abs-header', out.startswith('--- a/sub/bad.c\n+++ b/sub/bad.c\n'), out)
+
+		proc = subprocess.Popen(['patch', '-s', '-p1'], cwd=tmp, stdin=subprocess.PIPE)
+		proc.communicate(out)
+		check('diff-abs-patch', (proc.returncode == 0) and (read_file(path) == want))
+	finally:
+		shutil.rmtree(tmp)
+
+def walked(out):
+	"""Gets the sorted files from the PASS/FAIL lines of --check"""
+	names = [ line.split()[1] for line in out.splitlines() ]
+	names.sort()
+	return names
+
+def test_recursive():
+	"""--recursive takes the files with a known extension or that match an
+	include glob and skips the files and folders that match an exclude glob"""
+	tree = { 'README'         : GOOD_FILE,
+	         'build/z.c'      : GOOD_FILE,
+	         'src/a.c'        : GOOD_FILE,
+	         'src/b.cpp'      : GOOD_FILE,
+	         'src/gen/x.c'    : BAD_FILE,
+	         'src/notes.txt'  : GOOD_FILE,
+	         'src/skip_me.c'  : GOOD_FILE,
+	         'src/sub/y.h'    : GOOD_FILE }
+	tmp = make_folder(tree)
+	try:
+		all_src = [ 'build/z.c', 'src/a.c', 'src/b.cpp', 'src/gen/x.c',
+		            'src/skip_me.c', 'src/sub/y.h' ]
+		for jobs in [ '1', '2' ]:
+			rc, out = run(['--check', '-j', jobs, '--recursive', '.'], cwd=tmp)
+			check('recursive-known-j' + jobs,
+			      (rc == 1) and (walked(out) == [ './' + name for name in all_src ]), out)
+
+		rc, out = run(['--check', '--recursive', 'src', '--exclude', 'gen',
+		               '--exclude', '*_me.c', '--exclude', 'sub/*'], cwd=tmp)
+		check('recursive-exclude', (rc == 0) and (walked(out) == [ 'src/a.c', 'src/b.cpp' ]), out)
+
+		rc, out = run(['--check', '--recursive', 'src', '--include', '*.h',
+		               '--include', '*.txt'], cwd=tmp)
+		check('recursive-include', (rc == 0) and
+		      (walked(out) == [ 'src/notes.txt', 'src/sub/y.h' ]), out)
+
+		fd = open(os.path.join(tmp, 'ignore'), 'w')
+		fd.write('# the generated code\ngen/\n\nbuild\n')
+		fd.close()
+		rc, out = run(['--check', '--recursive', '.', '--ignore-file', 'ignore'], cwd=tmp)
+		check('recursive-ignore-file', (rc == 0) and
+		      (walked(out) == [ './src/a.c', './src/b.cpp', './src/skip_me.c', './src/sub/y.h' ]), out)
+		os.remove(os.path.join(tmp, 'ignore'))
+
+		# Only the file that needs it is replaced
+		rc, out = run(['--no-backup', '--recursive', 'src', '--exclude', '*.cpp'], cwd=tmp)
+		check('recursive-replace', (rc == 0) and (list_files(tmp) == sorted(tree.keys())),
+		      list_files(tmp))
+		check('recursive-replaced', read_file(os.path.join(tmp, 'src/gen/x.c')) == read_file(GOOD_FILE))
+	finally:
+		shutil.rmtree(tmp)
+
+def test_lines():
+	"""--lines prints the regions that hold the ranges and nothing for a range
+	past the end of the file"""
+	src = os.path.abspath('input/c/nl-semicolon.c')
+
+	rc, out = run(['--lines', '1000-2000', '-f', src])
+	check('lines-past-eof', (rc == 0) and (out == ''), out)
+
+	rc, out = run(['--lines', '18-2000', '-f', src])
+	check('lines-to-past-eof', (rc == 0) and out.startswith('@@ 15-21 @@\n'), out)
+
+def cache_entries(top):
+	return [ os.path.join(top, name) for name in list_files(top) ]
+
+def test_cache():
+	"""--cache gives the same output from a good entry and ignores a bad one"""
+	tmp   = make_folder({ 'bad.c' : BAD_FILE })
+	cache = os.path.join(tmp, 'cache')
+	want  = read_file(GOOD_FILE)
+	try:
+		rc, out = run(['--cache', cache, '-f', 'bad.c'], cwd=tmp)
+		check('cache-miss', (rc == 0) and (out == want))
+		entries = cache_entries(cache)
+		check('cache-stored', len(entries) == 1, entries)
+
+		rc, out = run(['--cache', cache, '-f', 'bad.c'], cwd=tmp)
+		check('cache-hit', (rc == 0) and (out == want))
+
+		# A truncated entry and one with a huge length are misses
+		entry  = read_file(entries[0])
+		for name, data in [ ('truncated', entry[:len(entry) // 2]),
+		                    ('huge', 'uncrustify-cache 99999999999999999\n') ]:
+			fd = open(entries[0], 'wb')
+			fd.write(data)
+			fd.close()
+			rc, out = run(['--cache', cache, '-f', 'bad.c'], cwd=tmp)
+			check('cache-' + name, (rc == 0) and (out == want), repr(out[:80]))
+			check('cache-' + name + '-restored', read_file(entries[0]) == entry)
+	finally:
+		shutil.rmtree(tmp)
+
+def read_replies(data):
+	"""Splits the output of --server into a list of (status, payload)"""
+	replies = []
+	while data:
+		header, data = data.split('\n', 1)
+		status, size = header.split()
+		replies.append((status, data[:int(size)]))
+		data = data[int(size):]
+	return replies
+
+def text_request(data):
+	return 'TEXT c %d\n%s' % (len(data), data)
+
+def run_server(requests):
+	"""Sends the requests to --server on stdin and returns the exit status and
+	the replies"""
+	proc = subprocess.Popen([UNCRUSTIFY, '-q', '-c', CONFIG, '--server'],
+	                        stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+	                        stderr=subprocess.PIPE)
+	out, err = proc.communicate(requests)
+	return proc.returncode, read_replies(out)
+
+def socket_request(path, requests):
+	"""Sends the requests to the --socket server and returns the replies, or
+	None if the server is gone"""
+	sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+	out  = ''
+	try:
+		sock.connect(path)
+		sock.sendall(requests)
+		sock.shutdown(socket.SHUT_WR)
+		while True:
+			data = sock.recv(65536)
+			if not data:
+				break
+			out += data
+	except socket.error:
+		return None
+	finally:
+		sock.close()
+	return read_replies(out)
+
+def test_server():
+	"""--server answers each request, and a bad request only ends its own session"""
+	bad_text = read_file(BAD_FILE)
+	want     = read_file(GOOD_FILE)
+
+	rc, replies = run_server(text_request(bad_text) +
+	                         'FILE - %d\n%s' % (len(BAD_FILE), BAD_FILE) +
+	                         text_request(want) + 'QUIT\n' + text_request(bad_text))
+	check('server-round-trip', (rc == 0) and (replies == [ ('OK', want) ] * 3), replies)
+
+	for header in [ 'HELLO\n', 'TEXT c\n', 'TEXT c many\n' ]:
+		rc, replies = run_server(header + text_request(bad_text))
+		check('server-bad-header ' + header.strip(), (rc == 0) and (len(replies) == 1) and
+		      (replies[0][0] == 'ERROR'), replies)
+
+	rc, replies = run_server('TEXT c 10\nint')
+	check('server-short-payload', (rc == 0) and (len(replies) == 1) and
+	      (replies[0][0] == 'ERROR'), replies)
+
+	rc, replies = run_server('TEXT C 99999999999999999\n' + text_request(bad_text))
+	check('server-too-large', (rc == 0) and (len(replies) == 1) and
+	      (replies[0][0] == 'ERROR'), replies)
+
+	tmp  = tempfile.mkdtemp(prefix='unc-cli-')
+	path = os.path.join(tmp, 'sock')
+	proc = subprocess.Popen([UNCRUSTIFY, '-q', '-c', CONFIG, '--server', '--socket', path],
+	                        stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+	try:
+		for tries in range(100):
+			if os.path.exists(path):
+				break
+			time.sleep(0.05)
+		check('socket-mode', (os.stat(path).st_mode & 0o077) == 0, oct(os.stat(path).st_mode))
+		replies = socket_request(path, 'TEXT C 99999999999999999\n')
+		check('socket-too-large', (replies is not None) and (len(replies) == 1) and (replies[0][0] == 'ERROR'), replies)
+		replies = socket_request(path, text_request(bad_text) + 'QUIT\n')
+		check('socket-round-trip', (proc.poll() is None) and (replies == [ ('OK', want) ]), replies)
+	finally:
+		if proc.poll() is None:
+			proc.kill()
+		proc.wait()
+		shutil.rmtree(tmp)
+
+#
+# entry point
+#
+
+if __name__ == '__main__':
+	test_check()
+	test_diff()
+	test_recursive()
+	test_lines()
+	test_cache()
+	test_server()
+
+	print "Passed %d / %d command line tests" % (pass_count, pass_count + fail_count)
+	if fail_count > 0:
+		sys.exit(1)
+	sys.exit(0)
@@ -69,8 +69,10 @@ typedef unsigned long long UINT64;
 #include <io.h>
 #include <fcntl.h>
 #include <direct.h>
+#include <process.h>
 
 #define mkdir(x, y) _mkdir(x)
+#define getpid      _getpid
 #define PATH_SEP  '\\'
 
 #endif   /* WINDOWS_COMPAT_H_INCLUDED */